@@ -0,0 +1,104 @@
+#!/bin/sh
+# Copyright (c) 2018 Ristretto Developers, Cryptography Research, Inc.
+# Released under the MIT License.  See LICENSE.txt for license information.
+#
+# Pick the table and window sizes of src/ristretto_config.h for this host.
+#
+# Usage: bench/autotune.sh [output.h]   (normally run as "make autotune")
+#
+# Each group of sizes only affects a few operations, so the groups are tuned
+# independently: every candidate is built with make TUNED=<candidate> and
+# scored by the summed median times of the operations it affects.  The
+# winners are written to output.h, for "make clean all TUNED=output.h".
+# Variables given to the calling make, such as ARCH, are passed on.
+
+set -e
+
+OUT=${1:-ristretto_tuned.h}
+MAKE=${MAKE:-make}
+SAMPLES=${AUTOTUNE_SAMPLES:-15}
+TMP=$(mktemp -d /tmp/ristretto-autotune.XXXXXX)
+trap 'rm -rf "$TMP"' EXIT
+
+# score "defines" "benchmarks...": build with the defines and print the
+# summed median nanoseconds of the named benchmarks
+score() {
+    printf '%b' "$1" > "$TMP/candidate.h"
+    shift
+    $MAKE clean > /dev/null
+    $MAKE TUNED="$TMP/candidate.h" build/obj/bin/bench > "$TMP/build.log" 2>&1 || {
+        echo "build failed:" >&2
+        cat "$TMP/build.log" >&2
+        return 1
+    }
+    ./build/obj/bin/bench --json --samples "$SAMPLES" "$@" | awk -F'"' -v want=" $* " '
+        $2 == "name" && index(want, " " $4 " ") {
+            split($0, f, "\"median_ns\": "); split(f[2], g, ","); total += g[1]
+        }
+        END { printf "%.0f\n", total }'
+}
+
+# tune "label" "benchmarks" candidate-defines...: print the best defines
+tune() {
+    label=$1; benches=$2; shift 2
+    best=; best_ns=
+    for defines in "$@"; do
+        ns=$(score "$defines" $benches)
+        printf '  %-48s %10s ns\n' "$(printf '%b' "$defines" | tr '\n' ' ' | sed 's/#define //g')" "$ns" >&2
+        if [ -z "$best_ns" ] || [ "$ns" -lt "$best_ns" ]; then
+            best=$defines; best_ns=$ns
+        fi
+    done
+    echo "$label: $(printf '%b' "$best" | tr '\n' ' ' | sed 's/#define //g')" >&2
+    printf '%s' "$best"
+}
+
+echo "window bits:" >&2
+WINDOW=$(tune window "point_scalarmul point_double_scalarmul point_dual_scalarmul" \
+    "#define RISTRETTO_WINDOW_BITS 3\n" \
+    "#define RISTRETTO_WINDOW_BITS 4\n" \
+    "#define RISTRETTO_WINDOW_BITS 5\n" \
+    "#define RISTRETTO_WINDOW_BITS 6\n")
+
+echo "combs (n t s):" >&2
+COMBS=
+for nts in "3 5 17" "2 5 26" "4 4 16" "2 6 22" "3 6 15" "4 5 13" "5 5 11" "2 7 19" "2 8 16"; do
+    set -- $nts
+    COMBS="$COMBS#define COMBS_N $1\n#define COMBS_T $2\n#define COMBS_S $3\n|"
+done
+OLDIFS=$IFS; IFS='|'
+set -- $COMBS
+IFS=$OLDIFS
+COMBS=$(tune combs "precomputed_scalarmul_base base_scalarmul_non_secret" "$@")
+
+# Whether packing the combs pays depends on their size, so this is tuned
+# with the combs just chosen, keeping only its own define
+echo "compact combs:" >&2
+COMPACT=$(tune compact "precomputed_scalarmul_base precomputed_scalarmul_many" \
+    "$COMBS#define RISTRETTO_COMPACT_COMBS 0\n" \
+    "$COMBS#define RISTRETTO_COMPACT_COMBS 1\n" | sed 's/.*\(#define RISTRETTO_COMPACT_COMBS\)/\1/')
+
+echo "wNAF table bits (fixed var):" >&2
+WNAF=
+for fixed in 4 5 6 7; do
+    for var in 2 3 4; do
+        WNAF="$WNAF#define RISTRETTO_WNAF_FIXED_TABLE_BITS $fixed\n#define RISTRETTO_WNAF_VAR_TABLE_BITS $var\n|"
+    done
+done
+IFS='|'
+set -- $WNAF
+IFS=$OLDIFS
+WNAF=$(tune wnaf "base_double_scalarmul_non_secret" "$@")
+
+echo "single wNAF table bits:" >&2
+SINGLE=$(tune single "point_scalarmul_non_secret precomputed_wnaf_scalarmul_non_secret" \
+    "#define RISTRETTO_WNAF_SINGLE_TABLE_BITS 4\n" \
+    "#define RISTRETTO_WNAF_SINGLE_TABLE_BITS 5\n" \
+    "#define RISTRETTO_WNAF_SINGLE_TABLE_BITS 6\n")
+
+$MAKE clean > /dev/null
+{
+    echo "/* Written by make autotune on $(uname -n), $(date -u +%Y-%m-%d). */"
+    printf '%b%b%b%b%b' "$WINDOW" "$COMBS" "$COMPACT" "$WNAF" "$SINGLE"
+} > "$OUT"
+echo "wrote $OUT; build with: $MAKE clean all TUNED=$OUT" >&2
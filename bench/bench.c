@@ -0,0 +1,338 @@
+/**
+ * @file bench.c
+ * @author Mike Hamburg
+ *
+ * @copyright
+ *   Copyright (c) 2015-2018 Ristretto Developers, Cryptography Research, Inc.  \n
+ *   Released under the MIT License.  See LICENSE.txt for license information.
+ *
+ * @brief Benchmarks for the public API and the field arithmetic of the
+ * ARCH backend it was built for.
+ *
+ * Usage: bench [--json] [--samples N] [name-substring ...]
+ *
+ * Each benchmark is calibrated to run for at least MIN_SAMPLE_NS per
+ * sample, warmed up, and then sampled; the median and tail percentiles of
+ * the per-item time are reported.  Times are in nanoseconds, and also in
+ * TSC ticks on x86.
+ */
+
+#define _XOPEN_SOURCE 600
+
+#include "word.h"
+#include "field.h"
+#include <ristretto255.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HAVE_TICKS 1
+static uint64_t ticks(void) { return __rdtsc(); }
+#else
+#define HAVE_TICKS 0
+static uint64_t ticks(void) { return 0; }
+#endif
+
+#ifndef BENCH_ARCH
+#define BENCH_ARCH "unknown"
+#endif
+
+#define MIN_SAMPLE_NS 200000.0
+#define DEFAULT_SAMPLES 31
+#define MAX_SAMPLES 1001
+
+/* Inputs to batch benchmarks; results are reported per item */
+#define N 64
+#define NPRE 8
+
+/* Comb tables cycled through by precomputed_scalarmul_many, too many for
+ * the caches to hold, as for a server with many keys */
+#define NMANY 1024
+
+#define SER_BYTES RISTRETTO255_SER_BYTES
+#define HASH_BYTES RISTRETTO255_HASH_BYTES
+#define point_t ristretto255_point_t
+#define scalar_t ristretto255_scalar_t
+
+/* Fixtures, built once by setup() */
+static gf_25519_t fa, fb, fc;
+static uint8_t fser[SER_BYTES];
+static scalar_t sa, sb, sc, sv[N], sw[N], sout[N];
+static point_t pa, pb, pc, pv[N];
+static ristretto255_point_block_t blk_a[RISTRETTO255_POINT_BLOCKS(N)], blk_b[RISTRETTO255_POINT_BLOCKS(N)],
+    blk_c[RISTRETTO255_POINT_BLOCKS(N)];
+static ristretto255_point_cached_t cached_b, cached_c, cached_v[N];
+static ristretto255_point_affine_cached_t affine_b, affine_v[N];
+static uint8_t ser_a[SER_BYTES], ser_v[N*SER_BYTES], ser_out[N*SER_BYTES], sbytes[64];
+static uint8_t hash[2*HASH_BYTES], hashes[N*2*HASH_BYTES], hints[N], inv_out[N*2*HASH_BYTES];
+static uint8_t inv_all[1<<RISTRETTO255_INVERT_ELLIGATOR_WHICH_BITS][2*HASH_BYTES];
+static uint8_t inv_all_nu[1<<RISTRETTO255_INVERT_ELLIGATOR_WHICH_BITS][HASH_BYTES];
+static ristretto_bool_t succ_v[N];
+static const uint8_t *msgs[N];
+static size_t msg_lens[N];
+static uint8_t msg_data[N][64];
+static ristretto255_hash_dst_t dst;
+static ristretto255_sha512_ctx_t sha;
+static ristretto255_hash_t hctx;
+static uint8_t digest[RISTRETTO255_SHA512_OUTPUT_BYTES];
+static ristretto255_precomputed_s *pre, *pre_v, *pre_tmp;
+static uint8_t *pre_many;
+static size_t many_next;
+static ristretto255_precomputed_wnaf_s *wnaf, *wnaf_v;
+static void *ws_pre, *ws_cache;
+static uint8_t *file_comb, *file_wnaf;
+static size_t file_comb_len, file_wnaf_len;
+static char file_path[64];
+static ristretto255_table_file_t view;
+static ristretto255_key_cache_t *cache;
+static uint8_t zero_buf[256];
+static volatile uint64_t sink;
+
+static void *xalign(size_t size) {
+    void *p;
+    if (posix_memalign(&p, ristretto255_alignof_precomputed_s, size ? size : 1)) {
+        fprintf(stderr, "out of memory\n");
+        exit(1);
+    }
+    memset(p, 0, size);
+    return p;
+}
+
+static void fill(uint8_t *buf, size_t len, uint64_t seed) {
+    size_t i;
+    for (i=0; i<len; i++) {
+        seed = seed*6364136223846793005ull + 1442695040888963407ull;
+        buf[i] = (uint8_t)(seed >> 56);
+    }
+}
+
+static void setup(void) {
+    uint8_t buf[64];
+    size_t i;
+    FILE *f;
+    int fd;
+
+    fill(buf, 64, 1); ristretto255_scalar_decode_long(&sa, buf, 64);
+    fill(buf, 64, 2); ristretto255_scalar_decode_long(&sb, buf, 64);
+    fill(sbytes, 64, 3);
+    fill(hash, sizeof(hash), 4);
+    fill(hashes, sizeof(hashes), 5);
+    fill(hints, sizeof(hints), 6);
+    for (i=0; i<N; i++) {
+        fill(buf, 64, 100+i); ristretto255_scalar_decode_long(&sv[i], buf, 64);
+        fill(buf, 64, 200+i); ristretto255_scalar_decode_long(&sw[i], buf, 64);
+        fill(msg_data[i], 64, 300+i);
+        msgs[i] = msg_data[i];
+        msg_lens[i] = 64;
+    }
+
+    ristretto255_point_from_hash_uniform(&pa, hash);
+    ristretto255_point_scalarmul(&pb, &pa, &sb);
+    ristretto255_point_encode(ser_a, &pa);
+    ristretto255_point_from_hash_uniform_batch(pv, hashes, N);
+    for (i=0; i<N; i++) ristretto255_point_encode(&ser_v[i*SER_BYTES], &pv[i]);
+    ristretto255_point_to_cached(&cached_b, &pb);
+    ristretto255_point_cached_normalize(&affine_b, &cached_b, 1);
+    for (i=0; i<N; i++) ristretto255_point_to_cached(&cached_v[i], &pv[i]);
+    ristretto255_point_block_load(blk_a, pv, N);
+    ristretto255_point_block_double(blk_b, blk_a, N);
+
+    (void)!gf_deserialize(&fa, ser_a, 1, 0);
+    ristretto255_point_encode(fser, &pb);
+    (void)!gf_deserialize(&fb, fser, 1, 0);
+
+    ristretto255_hash_dst_init(&dst, (const uint8_t *)"bench", 5);
+
+    pre = (ristretto255_precomputed_s *)xalign(ristretto255_sizeof_precomputed_s);
+    pre_tmp = (ristretto255_precomputed_s *)xalign(ristretto255_sizeof_precomputed_s);
+    pre_v = (ristretto255_precomputed_s *)xalign(NPRE*ristretto255_sizeof_precomputed_s);
+    wnaf = (ristretto255_precomputed_wnaf_s *)xalign(ristretto255_sizeof_precomputed_wnaf_s);
+    wnaf_v = (ristretto255_precomputed_wnaf_s *)xalign(N*ristretto255_sizeof_precomputed_wnaf_s);
+    ristretto255_precompute(pre, &pa);
+    ristretto255_precompute_batch(pre_v, pv, NPRE, 1);
+    pre_many = (uint8_t *)xalign(NMANY*ristretto255_sizeof_precomputed_s);
+    for (i=0; i<NMANY; i++) {
+        memcpy(&pre_many[i*ristretto255_sizeof_precomputed_s],
+            (const uint8_t *)pre_v + i%NPRE*ristretto255_sizeof_precomputed_s, ristretto255_sizeof_precomputed_s);
+    }
+    ristretto255_precompute_wnaf(wnaf, &pa);
+    for (i=0; i<N; i++) {
+        ristretto255_precompute_wnaf(
+            (ristretto255_precomputed_wnaf_s *)((uint8_t *)wnaf_v + i*ristretto255_sizeof_precomputed_wnaf_s), &pv[i]);
+    }
+    ws_pre = xalign(ristretto255_workspace_size(RISTRETTO255_WS_PRECOMPUTE_BATCH, NPRE));
+    ws_cache = xalign(ristretto255_workspace_size(RISTRETTO255_WS_KEY_CACHE, 1));
+
+    file_comb_len = ristretto255_table_file_bytes(RISTRETTO255_TABLE_COMB, NPRE);
+    file_wnaf_len = ristretto255_table_file_bytes(RISTRETTO255_TABLE_WNAF, N);
+    file_comb = (uint8_t *)xalign(file_comb_len);
+    file_wnaf = (uint8_t *)xalign(file_wnaf_len);
+    ristretto255_table_file_encode_comb(file_comb, pre_v, NPRE);
+    ristretto255_table_file_encode_wnaf(file_wnaf, wnaf_v, N);
+    (void)!ristretto255_table_file_view(&view, file_wnaf, file_wnaf_len, RISTRETTO255_TABLE_WNAF, RISTRETTO_FALSE);
+
+    strcpy(file_path, "/tmp/ristretto255-bench-XXXXXX");
+    fd = mkstemp(file_path);
+    f = fd < 0 ? NULL : fdopen(fd, "wb");
+    if (!f || fwrite(file_wnaf, 1, file_wnaf_len, f) != file_wnaf_len || fclose(f)) {
+        fprintf(stderr, "cannot write %s\n", file_path);
+        exit(1);
+    }
+
+    cache = ristretto255_key_cache_new(256);
+    if (!cache) exit(1);
+    (void)!ristretto255_key_cache_decode(&pc, cache, ser_a, RISTRETTO_FALSE);
+}
+
+static const ristretto255_precomputed_s *next_many(void) {
+    many_next = (many_next + 1) % NMANY;
+    return (const ristretto255_precomputed_s *)&pre_many[many_next*ristretto255_sizeof_precomputed_s];
+}
+
+typedef struct {
+    const char *name;
+    unsigned int items; /* items processed per call */
+    void (*run)(size_t iters);
+} bench_t;
+
+#define BENCH(name, items, ...) \
+    static void bench_##name(size_t iters) { \
+        size_t it_; \
+        for (it_=0; it_<iters; it_++) { __VA_ARGS__; } \
+    }
+#include "bench_cases.h"
+#undef BENCH
+
+#define BENCH(name, items, ...) { #name, items, bench_##name },
+static const bench_t benches[] = {
+#include "bench_cases.h"
+};
+#undef BENCH
+
+static double now_ns(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double)t.tv_sec*1e9 + (double)t.tv_nsec;
+}
+
+static int cmp_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+/* Nearest-rank percentile of sorted samples */
+static double percentile(const double *sorted, int n, double p) {
+    int rank = (int)(p*n + 0.999999);
+    if (rank < 1) rank = 1;
+    return sorted[rank-1];
+}
+
+typedef struct {
+    size_t iters;
+    double median, p90, p99, min, median_ticks;
+} result_t;
+
+static void measure(const bench_t *b, int samples, result_t *r) {
+    static double ns[MAX_SAMPLES], tk[MAX_SAMPLES];
+    size_t iters = 1;
+    double t;
+    int i;
+
+    /* Calibrate, which also warms up */
+    for (;;) {
+        t = now_ns();
+        b->run(iters);
+        t = now_ns() - t;
+        if (t >= MIN_SAMPLE_NS || iters >= ((size_t)1 << 30)) break;
+        iters = t > 0 ? (size_t)(iters * (1.2*MIN_SAMPLE_NS/t)) + 1 : iters*2;
+    }
+    b->run(iters);
+
+    for (i=0; i<samples; i++) {
+        uint64_t k = ticks();
+        t = now_ns();
+        b->run(iters);
+        t = now_ns() - t;
+        k = ticks() - k;
+        ns[i] = t / (double)iters / b->items;
+        tk[i] = (double)k / (double)iters / b->items;
+    }
+
+    qsort(ns, samples, sizeof(double), cmp_double);
+    qsort(tk, samples, sizeof(double), cmp_double);
+    r->iters = iters;
+    r->median = percentile(ns, samples, 0.5);
+    r->p90 = percentile(ns, samples, 0.9);
+    r->p99 = percentile(ns, samples, 0.99);
+    r->min = ns[0];
+    r->median_ticks = percentile(tk, samples, 0.5);
+}
+
+static int selected(const char *name, int nfilters, char **filters) {
+    int i;
+    if (!nfilters) return 1;
+    for (i=0; i<nfilters; i++) {
+        if (strstr(name, filters[i])) return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    int json = 0, samples = DEFAULT_SAMPLES, nfilters = 0, first = 1;
+    char **filters = (char **)calloc(argc, sizeof(char *));
+    size_t i;
+    int a;
+
+    for (a=1; a<argc; a++) {
+        if (!strcmp(argv[a], "--json")) {
+            json = 1;
+        } else if (!strcmp(argv[a], "--samples") && a+1 < argc) {
+            samples = atoi(argv[++a]);
+            if (samples < 1) samples = 1;
+            if (samples > MAX_SAMPLES) samples = MAX_SAMPLES;
+        } else {
+            filters[nfilters++] = argv[a];
+        }
+    }
+
+    setup();
+
+    if (json) {
+        printf("{\"arch\": \"%s\", \"ticks\": %s, \"samples\": %d, \"results\": [\n",
+            BENCH_ARCH, HAVE_TICKS ? "true" : "false", samples);
+    } else {
+        printf("# arch %s, %d samples, per-item times\n", BENCH_ARCH, samples);
+        printf("%-56s %5s %11s %11s %11s %11s\n", "benchmark", "items",
+            "median ns", "p90 ns", "p99 ns", HAVE_TICKS ? "med ticks" : "");
+    }
+
+    for (i=0; i<sizeof(benches)/sizeof(benches[0]); i++) {
+        result_t r;
+        if (!selected(benches[i].name, nfilters, filters)) continue;
+        measure(&benches[i], samples, &r);
+
+        if (json) {
+            printf("%s  {\"name\": \"%s\", \"items\": %u, \"iters\": %lu, \"median_ns\": %.2f, "
+                "\"p90_ns\": %.2f, \"p99_ns\": %.2f, \"min_ns\": %.2f, \"median_ticks\": %.1f}",
+                first ? "" : ",\n", benches[i].name, benches[i].items, (unsigned long)r.iters,
+                r.median, r.p90, r.p99, r.min, r.median_ticks);
+        } else {
+            printf("%-56s %5u %11.1f %11.1f %11.1f", benches[i].name, benches[i].items,
+                r.median, r.p90, r.p99);
+            if (HAVE_TICKS) printf(" %11.0f", r.median_ticks);
+            printf("\n");
+        }
+        fflush(stdout);
+        first = 0;
+    }
+    if (json) printf("\n]}\n");
+
+    ristretto255_key_cache_free(cache);
+    unlink(file_path);
+    free(filters);
+    return 0;
+}
@@ -0,0 +1,152 @@
+/**
+ * @file bench_cases.h
+ * @brief The benchmarks run by bench.c, as BENCH(name, items, body).
+ *
+ * Included twice by bench.c, once to define each body and once to list
+ * them.  The body runs once per iteration, over the fixtures of setup().
+ */
+
+/* Field arithmetic of the ARCH backend */
+BENCH(gf_mul, 1, gf_mul(&fc, &fa, &fb))
+BENCH(gf_sqr, 1, gf_sqr(&fc, &fa))
+BENCH(gf_isr, 1, sink += gf_isr(&fc, &fa))
+BENCH(gf_add, 1, gf_add(&fc, &fa, &fb))
+BENCH(gf_sub, 1, gf_sub(&fc, &fa, &fb))
+BENCH(gf_strong_reduce, 1, gf_strong_reduce(&fa))
+BENCH(gf_serialize, 1, gf_serialize(fser, &fa, 1))
+BENCH(gf_deserialize, 1, sink += gf_deserialize(&fc, fser, 1, 0))
+
+/* Scalars */
+BENCH(scalar_decode, 1, sink += ristretto255_scalar_decode(&sc, sbytes))
+BENCH(scalar_decode_long, 1, ristretto255_scalar_decode_long(&sc, sbytes, 64))
+BENCH(scalar_encode, 1, ristretto255_scalar_encode(sbytes, &sa))
+BENCH(scalar_add, 1, ristretto255_scalar_add(&sc, &sa, &sb))
+BENCH(scalar_sub, 1, ristretto255_scalar_sub(&sc, &sa, &sb))
+BENCH(scalar_mul, 1, ristretto255_scalar_mul(&sc, &sa, &sb))
+BENCH(scalar_halve, 1, ristretto255_scalar_halve(&sc, &sa))
+BENCH(scalar_invert, 1, sink += ristretto255_scalar_invert(&sc, &sa))
+BENCH(scalar_eq, 1, sink += ristretto255_scalar_eq(&sa, &sb))
+BENCH(scalar_set_unsigned, 1, ristretto255_scalar_set_unsigned(&sc, it_))
+BENCH(scalar_cond_sel, 1, ristretto255_scalar_cond_sel(&sc, &sa, &sb, (ristretto_bool_t)(it_&1)))
+BENCH(scalar_copy, 1, ristretto255_scalar_copy(&sc, &sa))
+BENCH(scalar_destroy, 1, ristretto255_scalar_destroy(&sc))
+BENCH(scalar_mul_batch, N, ristretto255_scalar_mul_batch(sout, sv, sw, N))
+BENCH(scalar_add_batch, N, ristretto255_scalar_add_batch(sout, sv, sw, N))
+BENCH(scalar_sub_batch, N, ristretto255_scalar_sub_batch(sout, sv, sw, N))
+
+/* Points */
+BENCH(point_encode, 1, ristretto255_point_encode(ser_out, &pa))
+BENCH(point_decode, 1, sink += ristretto255_point_decode(&pc, ser_a, RISTRETTO_FALSE))
+BENCH(point_eq, 1, sink += ristretto255_point_eq(&pa, &pb))
+BENCH(point_valid, 1, sink += ristretto255_point_valid(&pa))
+BENCH(point_add, 1, ristretto255_point_add(&pc, &pa, &pb))
+BENCH(point_sub, 1, ristretto255_point_sub(&pc, &pa, &pb))
+BENCH(point_double, 1, ristretto255_point_double(&pc, &pa))
+BENCH(point_negate, 1, ristretto255_point_negate(&pc, &pa))
+BENCH(point_cond_sel, 1, ristretto255_point_cond_sel(&pc, &pa, &pb, (ristretto_bool_t)(it_&1)))
+BENCH(point_copy, 1, ristretto255_point_copy(&pc, &pa))
+BENCH(point_destroy, 1, ristretto255_point_destroy(&pc))
+BENCH(point_debugging_torque, 1, ristretto255_point_debugging_torque(&pc, &pa))
+BENCH(point_debugging_pscale, 1, ristretto255_point_debugging_pscale(&pc, &pa, fser))
+
+/* Cached points */
+BENCH(point_to_cached, 1, ristretto255_point_to_cached(&cached_c, &pa))
+BENCH(point_add_cached, 1, ristretto255_point_add_cached(&pc, &pa, &cached_b))
+BENCH(point_sub_cached, 1, ristretto255_point_sub_cached(&pc, &pa, &cached_b))
+BENCH(point_cached_normalize, N, ristretto255_point_cached_normalize(affine_v, cached_v, N))
+BENCH(point_add_affine_cached, 1, ristretto255_point_add_affine_cached(&pc, &pa, &affine_b))
+BENCH(point_sub_affine_cached, 1, ristretto255_point_sub_affine_cached(&pc, &pa, &affine_b))
+
+/* Sums */
+BENCH(point_sum, N, ristretto255_point_sum(&pc, pv, N, 1))
+BENCH(point_decode_sum, N, sink += ristretto255_point_decode_sum(&pc, ser_v, N, RISTRETTO_FALSE, 1))
+
+/* Point blocks */
+BENCH(point_block_load, N, ristretto255_point_block_load(blk_c, pv, N))
+BENCH(point_block_store, N, ristretto255_point_block_store(pv, blk_a, N))
+BENCH(point_block_add, N, ristretto255_point_block_add(blk_c, blk_a, blk_b, N))
+BENCH(point_block_double, N, ristretto255_point_block_double(blk_c, blk_a, N))
+BENCH(point_block_encode, N, ristretto255_point_block_encode(ser_out, blk_a, N))
+BENCH(point_block_decode, N, sink += ristretto255_point_block_decode(blk_c, succ_v, ser_v, N, RISTRETTO_FALSE))
+
+/* Scalar multiplication */
+BENCH(point_scalarmul, 1, ristretto255_point_scalarmul(&pc, &pa, &sa))
+BENCH(point_scalarmul_non_secret, 1, ristretto255_point_scalarmul_non_secret(&pc, &pa, &sa))
+BENCH(point_double_scalarmul, 1, ristretto255_point_double_scalarmul(&pc, &pa, &sa, &pb, &sb))
+BENCH(point_dual_scalarmul, 1, ristretto255_point_dual_scalarmul(&pc, &pb, &pa, &sa, &sb))
+BENCH(point_scalarmul_multiples, N, ristretto255_point_scalarmul_multiples(pv, &pa, sv, N))
+BENCH(point_scalarmul_multiples_non_secret, N, ristretto255_point_scalarmul_multiples_non_secret(pv, &pa, sv, N))
+BENCH(direct_scalarmul, 1, sink += ristretto255_direct_scalarmul(ser_out, ser_a, &sa, RISTRETTO_FALSE, RISTRETTO_TRUE))
+BENCH(direct_scalarmul_fanout, N, sink += ristretto255_direct_scalarmul_fanout(ser_out, succ_v, ser_v, &sa, N, RISTRETTO_FALSE))
+BENCH(precompute, 1, ristretto255_precompute(pre_tmp, &pa))
+BENCH(precompute_batch, NPRE, ristretto255_precompute_batch(pre_v, pv, NPRE, 1))
+BENCH(precompute_batch_ws, NPRE, ristretto255_precompute_batch_ws(pre_v, pv, NPRE, ws_pre))
+BENCH(precomputed_scalarmul, 1, ristretto255_precomputed_scalarmul(&pc, pre, &sa))
+BENCH(precomputed_scalarmul_base, 1, ristretto255_precomputed_scalarmul(&pc, ristretto255_precomputed_base, &sa))
+BENCH(precomputed_scalarmul_many, 1, ristretto255_precomputed_scalarmul(&pc, next_many(), &sa))
+BENCH(precomputed_destroy, 1, ristretto255_precomputed_destroy(pre_tmp))
+BENCH(precompute_wnaf, 1, ristretto255_precompute_wnaf(wnaf, &pa))
+BENCH(precomputed_wnaf_scalarmul_non_secret, 1, ristretto255_precomputed_wnaf_scalarmul_non_secret(&pc, wnaf, &sa))
+BENCH(precomputed_wnaf_base_double_scalarmul_non_secret, 1,
+    ristretto255_precomputed_wnaf_base_double_scalarmul_non_secret(&pc, &sa, wnaf, &sb))
+BENCH(base_scalarmul_non_secret, 1, ristretto255_base_scalarmul_non_secret(&pc, &sa))
+BENCH(base_double_scalarmul_non_secret, 1, ristretto255_base_double_scalarmul_non_secret(&pc, &sa, &pa, &sb))
+
+/* Elligator */
+BENCH(point_from_hash_nonuniform, 1, ristretto255_point_from_hash_nonuniform(&pc, hash))
+BENCH(point_from_hash_uniform, 1, ristretto255_point_from_hash_uniform(&pc, hash))
+BENCH(point_from_hash_uniform_batch, N, ristretto255_point_from_hash_uniform_batch(pv, hashes, N))
+BENCH(invert_elligator_nonuniform, 1, sink += ristretto255_invert_elligator_nonuniform(inv_out, &pa, (uint32_t)it_))
+BENCH(invert_elligator_uniform, 1, sink += ristretto255_invert_elligator_uniform(inv_out, &pa, (uint32_t)it_))
+BENCH(invert_elligator_uniform_batch, N, sink += ristretto255_invert_elligator_uniform_batch(inv_out, succ_v, pv, hints, N))
+BENCH(invert_elligator_nonuniform_all, 1, sink += ristretto255_invert_elligator_nonuniform_all(inv_all_nu, &pa))
+BENCH(invert_elligator_uniform_all, 1, sink += ristretto255_invert_elligator_uniform_all(inv_all, &pa, hash))
+
+/* Hashing */
+BENCH(sha512_hash_64, 1, ristretto255_sha512_hash(digest, sbytes, 64))
+BENCH(sha512_init_update_final_64, 1,
+    ristretto255_sha512_init(&sha); ristretto255_sha512_update(&sha, sbytes, 64); ristretto255_sha512_final(&sha, digest))
+BENCH(hash_dst_init, 1, ristretto255_hash_dst_init(&dst, (const uint8_t *)"bench", 5))
+BENCH(hash_init_update_final_64, 1,
+    ristretto255_hash_init(&hctx, &dst); ristretto255_hash_update(&hctx, sbytes, 64);
+    sink += ristretto255_hash_final(&hctx, digest, sizeof(digest)))
+BENCH(hash_final_to_group, 1,
+    ristretto255_hash_init(&hctx, &dst); ristretto255_hash_final_to_group(&pc, &hctx))
+BENCH(hash_final_to_scalar, 1,
+    ristretto255_hash_init(&hctx, &dst); ristretto255_hash_final_to_scalar(&sc, &hctx))
+BENCH(hash_to_group, 1, ristretto255_hash_to_group(&pc, sbytes, 64, &dst))
+BENCH(hash_to_scalar, 1, ristretto255_hash_to_scalar(&sc, sbytes, 64, &dst))
+BENCH(hash_to_group_batch, N, ristretto255_hash_to_group_batch(pv, msgs, msg_lens, N, &dst))
+BENCH(hash_to_scalar_batch, N, ristretto255_hash_to_scalar_batch(sout, msgs, msg_lens, N, &dst))
+
+/* Table files */
+BENCH(workspace_size, 1, sink += ristretto255_workspace_size(RISTRETTO255_WS_PRECOMPUTE_BATCH, it_))
+BENCH(table_file_bytes, 1, sink += ristretto255_table_file_bytes(RISTRETTO255_TABLE_WNAF, it_))
+BENCH(table_file_encode_comb, NPRE, ristretto255_table_file_encode_comb(file_comb, pre_v, NPRE))
+BENCH(table_file_encode_wnaf, N, ristretto255_table_file_encode_wnaf(file_wnaf, wnaf_v, N))
+BENCH(table_file_view, 1,
+    sink += ristretto255_table_file_view(&view, file_wnaf, file_wnaf_len, RISTRETTO255_TABLE_WNAF, RISTRETTO_FALSE))
+BENCH(table_file_view_verify, N,
+    sink += ristretto255_table_file_view(&view, file_wnaf, file_wnaf_len, RISTRETTO255_TABLE_WNAF, RISTRETTO_TRUE))
+BENCH(table_file_map_unmap, 1,
+    ristretto255_table_file_t map;
+    sink += ristretto255_table_file_map(&map, file_path, RISTRETTO255_TABLE_WNAF, RISTRETTO_FALSE);
+    ristretto255_table_file_unmap(&map))
+BENCH(table_file_wnaf, 1, sink += (uintptr_t)ristretto255_table_file_wnaf(&view, it_ % N))
+BENCH(table_file_comb, 1, sink += (uintptr_t)ristretto255_table_file_comb(&view, it_ % N))
+
+/* Key cache, all hits but the first */
+BENCH(key_cache_new_free, 1, ristretto255_key_cache_free(ristretto255_key_cache_new(256)))
+BENCH(key_cache_stats, 1, uint64_t h; uint64_t m; ristretto255_key_cache_stats(cache, &h, &m); sink += h+m)
+BENCH(key_cache_decode, 1, sink += ristretto255_key_cache_decode(&pc, cache, ser_a, RISTRETTO_FALSE))
+BENCH(key_cache_scalarmul_non_secret, 1,
+    sink += ristretto255_key_cache_scalarmul_non_secret(&pc, cache, ser_a, &sa, RISTRETTO_FALSE))
+BENCH(key_cache_scalarmul_non_secret_ws, 1,
+    sink += ristretto255_key_cache_scalarmul_non_secret_ws(&pc, cache, ser_a, &sa, RISTRETTO_FALSE, ws_cache))
+BENCH(key_cache_base_double_scalarmul_non_secret, 1,
+    sink += ristretto255_key_cache_base_double_scalarmul_non_secret(&pc, cache, &sa, ser_a, &sb, RISTRETTO_FALSE))
+BENCH(key_cache_base_double_scalarmul_non_secret_ws, 1,
+    sink += ristretto255_key_cache_base_double_scalarmul_non_secret_ws(&pc, cache, &sa, ser_a, &sb, RISTRETTO_FALSE, ws_cache))
+
+/* Utilities */
+BENCH(bzero_256, 1, ristretto_bzero(zero_buf, sizeof(zero_buf)))
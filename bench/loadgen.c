@@ -0,0 +1,415 @@
+/**
+ * @file loadgen.c
+ * @author Mike Hamburg
+ *
+ * @copyright
+ *   Copyright (c) 2015-2018 Ristretto Developers, Cryptography Research, Inc.  \n
+ *   Released under the MIT License.  See LICENSE.txt for license information.
+ *
+ * @brief Multi-threaded load generator: a mix of keygen, DH, sign and
+ * verify on many threads at once, reporting throughput and latency
+ * percentiles per operation.
+ *
+ * Usage: loadgen [--threads N] [--seconds S] [--warmup S] [--keys K]
+ *                [--mix keygen=W,dh=W,sign=W,verify=W]
+ *                [--verify table|cache|decode] [--json]
+ *
+ * All threads share ristretto255_precomputed_base and a pool of K keys.
+ * Verification looks up the signer's key by one of three paths: the key's
+ * shared wNAF table, a shared key cache in front of its encoding, or a
+ * fresh decode.  Sign and verify are Schnorr signatures over the group,
+ * with challenges from ristretto255_hash_to_scalar.
+ */
+
+#define _XOPEN_SOURCE 600
+
+#include <ristretto255.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define SER_BYTES RISTRETTO255_SER_BYTES
+#define SCALAR_BYTES RISTRETTO255_SCALAR_BYTES
+#define point_t ristretto255_point_t
+#define scalar_t ristretto255_scalar_t
+
+#define MAX_THREADS 256
+#define MSG_BYTES 32
+
+enum { OP_KEYGEN, OP_DH, OP_SIGN, OP_VERIFY, NOPS };
+static const char *const op_names[NOPS] = { "keygen", "dh", "sign", "verify" };
+
+enum { VERIFY_TABLE, VERIFY_CACHE, VERIFY_DECODE };
+static const char *const verify_names[] = { "table", "cache", "decode" };
+
+/* Latency histogram: exact below 2^HIST_SUB_BITS ns, then 2^HIST_SUB_BITS
+ * buckets per power of two, so percentiles are within about 3% */
+#define HIST_SUB_BITS 5
+#define HIST_BUCKETS (60<<HIST_SUB_BITS)
+
+typedef struct {
+    uint64_t bucket[HIST_BUCKETS];
+    uint64_t count, max;
+} hist_t;
+
+static unsigned int hist_index(uint64_t ns) {
+    unsigned int msb = 0;
+    if (ns < (1u<<HIST_SUB_BITS)) return (unsigned int)ns;
+    while (ns >> (msb+1)) msb++;
+    return ((msb-HIST_SUB_BITS+1) << HIST_SUB_BITS)
+        | (unsigned int)((ns >> (msb-HIST_SUB_BITS)) & ((1u<<HIST_SUB_BITS)-1));
+}
+
+/* The largest latency that falls in bucket i */
+static uint64_t hist_upper(unsigned int i) {
+    unsigned int e = i >> HIST_SUB_BITS;
+    uint64_t m = (i & ((1u<<HIST_SUB_BITS)-1)) | (1u<<HIST_SUB_BITS);
+    if (e == 0) return i;
+    return ((m+1) << (e-1)) - 1;
+}
+
+static void hist_add(hist_t *h, uint64_t ns) {
+    h->bucket[hist_index(ns)]++;
+    h->count++;
+    if (ns > h->max) h->max = ns;
+}
+
+static uint64_t hist_percentile(const hist_t *h, double p) {
+    uint64_t rank = (uint64_t)(p * (double)h->count + 0.999999), seen = 0;
+    unsigned int i;
+    if (rank < 1) rank = 1;
+    for (i=0; i<HIST_BUCKETS; i++) {
+        seen += h->bucket[i];
+        if (seen >= rank) return hist_upper(i) < h->max ? hist_upper(i) : h->max;
+    }
+    return h->max;
+}
+
+/* A key in the shared pool, with a signature made by it */
+typedef struct {
+    scalar_t secret;
+    uint8_t public_ser[SER_BYTES];
+    ristretto255_precomputed_wnaf_s *table;
+    uint8_t msg[MSG_BYTES];
+    uint8_t sig_r[SER_BYTES];
+    scalar_t sig_s;
+} pool_key_t;
+
+/* Settings, and state shared by all threads */
+static unsigned int nthreads = 0, nkeys = 1024, verify_mode = VERIFY_TABLE;
+static double seconds = 3, warmup = 0.5;
+static unsigned int mix[NOPS] = { 1, 1, 1, 1 };
+static pool_key_t *keys;
+static ristretto255_key_cache_t *cache;
+static ristretto255_hash_dst_t dst;
+static pthread_barrier_t start_barrier;
+
+typedef struct {
+    pthread_t thread;
+    uint64_t rng;
+    hist_t hist[NOPS];
+    uint64_t failures;
+    double elapsed;
+} worker_t;
+
+static uint64_t rng_next(uint64_t *state) {
+    *state = *state*6364136223846793005ull + 1442695040888963407ull;
+    return *state >> 11;
+}
+
+static void rng_fill(uint64_t *state, uint8_t *buf, size_t len) {
+    size_t i;
+    for (i=0; i<len; i++) buf[i] = (uint8_t)(rng_next(state) >> 40);
+}
+
+static uint64_t now_ns(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t)t.tv_sec*1000000000u + (uint64_t)t.tv_nsec;
+}
+
+/* c = H(R || A || msg) */
+static void challenge(
+    scalar_t *c,
+    const uint8_t r[SER_BYTES],
+    const uint8_t a[SER_BYTES],
+    const uint8_t msg[MSG_BYTES]
+) {
+    uint8_t buf[2*SER_BYTES + MSG_BYTES];
+    memcpy(buf, r, SER_BYTES);
+    memcpy(buf+SER_BYTES, a, SER_BYTES);
+    memcpy(buf+2*SER_BYTES, msg, MSG_BYTES);
+    ristretto255_hash_to_scalar(c, buf, sizeof(buf), &dst);
+}
+
+static void sign(
+    uint8_t r_ser[SER_BYTES],
+    scalar_t *s,
+    const pool_key_t *key,
+    const uint8_t msg[MSG_BYTES]
+) {
+    uint8_t buf[SCALAR_BYTES + MSG_BYTES];
+    scalar_t r, c;
+    point_t big_r;
+
+    /* Deterministic nonce r = H(secret || msg) */
+    ristretto255_scalar_encode(buf, &key->secret);
+    memcpy(buf+SCALAR_BYTES, msg, MSG_BYTES);
+    ristretto255_hash_to_scalar(&r, buf, sizeof(buf), &dst);
+
+    ristretto255_precomputed_scalarmul(&big_r, ristretto255_precomputed_base, &r);
+    ristretto255_point_encode(r_ser, &big_r);
+    challenge(&c, r_ser, key->public_ser, msg);
+    ristretto255_scalar_mul(s, &c, &key->secret);
+    ristretto255_scalar_add(s, s, &r);
+
+    ristretto255_scalar_destroy(&r);
+    ristretto_bzero(buf, sizeof(buf));
+}
+
+/* s*B - c*A == R */
+static int verify(const pool_key_t *key) {
+    scalar_t c;
+    point_t combo, a;
+    uint8_t combo_ser[SER_BYTES];
+
+    challenge(&c, key->sig_r, key->public_ser, key->msg);
+    ristretto255_scalar_sub(&c, &ristretto255_scalar_zero, &c);
+
+    switch (verify_mode) {
+    case VERIFY_TABLE:
+        ristretto255_precomputed_wnaf_base_double_scalarmul_non_secret(&combo, &key->sig_s, key->table, &c);
+        break;
+    case VERIFY_CACHE:
+        if (ristretto255_key_cache_base_double_scalarmul_non_secret(
+            &combo, cache, &key->sig_s, key->public_ser, &c, RISTRETTO_FALSE) != RISTRETTO_SUCCESS
+        ) {
+            return 0;
+        }
+        break;
+    default:
+        if (ristretto255_point_decode(&a, key->public_ser, RISTRETTO_FALSE) != RISTRETTO_SUCCESS) return 0;
+        ristretto255_base_double_scalarmul_non_secret(&combo, &key->sig_s, &a, &c);
+        break;
+    }
+
+    ristretto255_point_encode(combo_ser, &combo);
+    return !memcmp(combo_ser, key->sig_r, SER_BYTES);
+}
+
+static int run_op(worker_t *w, unsigned int op) {
+    const pool_key_t *key = &keys[rng_next(&w->rng) % nkeys];
+    uint8_t bytes[64], ser[SER_BYTES];
+    scalar_t secret, s;
+    point_t p;
+
+    switch (op) {
+    case OP_KEYGEN:
+        rng_fill(&w->rng, bytes, sizeof(bytes));
+        ristretto255_scalar_decode_long(&secret, bytes, sizeof(bytes));
+        ristretto255_precomputed_scalarmul(&p, ristretto255_precomputed_base, &secret);
+        ristretto255_point_encode(ser, &p);
+        ristretto255_scalar_destroy(&secret);
+        return 1;
+    case OP_DH:
+        return ristretto255_direct_scalarmul(
+            ser, key->public_ser, &keys[rng_next(&w->rng) % nkeys].secret, RISTRETTO_FALSE, RISTRETTO_TRUE
+        ) == RISTRETTO_SUCCESS;
+    case OP_SIGN:
+        rng_fill(&w->rng, bytes, MSG_BYTES);
+        sign(ser, &s, key, bytes);
+        return 1;
+    default:
+        return verify(key);
+    }
+}
+
+static void *worker(void *arg) {
+    worker_t *w = (worker_t *)arg;
+    unsigned int total = 0, op;
+    uint64_t start, measure, stop, t0, t1;
+
+    for (op=0; op<NOPS; op++) total += mix[op];
+
+    pthread_barrier_wait(&start_barrier);
+    start = now_ns();
+    measure = start + (uint64_t)(warmup*1e9);
+    stop = measure + (uint64_t)(seconds*1e9);
+
+    for (t1 = start; t1 < stop; ) {
+        unsigned int pick = (unsigned int)(rng_next(&w->rng) % total);
+        for (op=0; pick >= mix[op]; op++) pick -= mix[op];
+
+        t0 = now_ns();
+        if (!run_op(w, op)) w->failures++;
+        t1 = now_ns();
+        if (t0 >= measure) hist_add(&w->hist[op], t1-t0);
+    }
+    w->elapsed = (double)(t1 - measure) / 1e9;
+    return NULL;
+}
+
+static void setup_keys(void) {
+    uint64_t rng = 1;
+    uint8_t bytes[64];
+    point_t p;
+    unsigned int i;
+
+    keys = (pool_key_t *)calloc(nkeys, sizeof(pool_key_t));
+    if (!keys) exit(1);
+    ristretto255_hash_dst_init(&dst, (const uint8_t *)"loadgen", 7);
+
+    for (i=0; i<nkeys; i++) {
+        pool_key_t *key = &keys[i];
+        rng_fill(&rng, bytes, sizeof(bytes));
+        ristretto255_scalar_decode_long(&key->secret, bytes, sizeof(bytes));
+        ristretto255_precomputed_scalarmul(&p, ristretto255_precomputed_base, &key->secret);
+        ristretto255_point_encode(key->public_ser, &p);
+
+        if (posix_memalign((void **)&key->table, ristretto255_alignof_precomputed_s,
+            ristretto255_sizeof_precomputed_wnaf_s)) exit(1);
+        ristretto255_precompute_wnaf(key->table, &p);
+
+        rng_fill(&rng, key->msg, MSG_BYTES);
+        sign(key->sig_r, &key->sig_s, key, key->msg);
+    }
+
+    if (verify_mode == VERIFY_CACHE) {
+        cache = ristretto255_key_cache_new(nkeys);
+        if (!cache) exit(1);
+    }
+}
+
+static int parse_mix(const char *arg) {
+    char name[16];
+    unsigned int weight, op;
+    int used;
+    memset(mix, 0, sizeof(mix));
+    while (*arg) {
+        if (sscanf(arg, "%15[a-z]=%u%n", name, &weight, &used) != 2) return 0;
+        for (op=0; op<NOPS && strcmp(name, op_names[op]); op++) {}
+        if (op == NOPS) return 0;
+        mix[op] = weight;
+        arg += used;
+        if (*arg == ',') arg++;
+    }
+    return mix[OP_KEYGEN] + mix[OP_DH] + mix[OP_SIGN] + mix[OP_VERIFY] > 0;
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr, "usage: %s [--threads N] [--seconds S] [--warmup S] [--keys K]\n"
+        "    [--mix keygen=W,dh=W,sign=W,verify=W] [--verify table|cache|decode] [--json]\n", prog);
+    exit(1);
+}
+
+int main(int argc, char **argv) {
+    worker_t *workers;
+    hist_t *hist;
+    uint64_t failures = 0, total_count = 0;
+    double elapsed = 0;
+    int json = 0, first = 1, a;
+    unsigned int i, op;
+
+    for (a=1; a<argc; a++) {
+        const char *val = a+1 < argc ? argv[a+1] : NULL;
+        if (!strcmp(argv[a], "--json")) {
+            json = 1;
+        } else if (!val) {
+            usage(argv[0]);
+        } else if (!strcmp(argv[a], "--threads")) {
+            nthreads = (unsigned int)atoi(val); a++;
+        } else if (!strcmp(argv[a], "--seconds")) {
+            seconds = atof(val); a++;
+        } else if (!strcmp(argv[a], "--warmup")) {
+            warmup = atof(val); a++;
+        } else if (!strcmp(argv[a], "--keys")) {
+            nkeys = (unsigned int)atoi(val); a++;
+        } else if (!strcmp(argv[a], "--mix")) {
+            if (!parse_mix(val)) usage(argv[0]);
+            a++;
+        } else if (!strcmp(argv[a], "--verify")) {
+            for (verify_mode=0; verify_mode<3 && strcmp(val, verify_names[verify_mode]); verify_mode++) {}
+            if (verify_mode == 3) usage(argv[0]);
+            a++;
+        } else {
+            usage(argv[0]);
+        }
+    }
+    if (nthreads == 0) {
+        long n = sysconf(_SC_NPROCESSORS_ONLN);
+        nthreads = n > 0 ? (unsigned int)n : 1;
+    }
+    if (nthreads > MAX_THREADS) nthreads = MAX_THREADS;
+    if (nkeys == 0 || seconds <= 0 || warmup < 0) usage(argv[0]);
+
+    setup_keys();
+
+    workers = (worker_t *)calloc(nthreads, sizeof(worker_t));
+    hist = (hist_t *)calloc(NOPS, sizeof(hist_t));
+    if (!workers || !hist) exit(1);
+    pthread_barrier_init(&start_barrier, NULL, nthreads);
+    for (i=0; i<nthreads; i++) {
+        workers[i].rng = 0x9e3779b97f4a7c15ull * (i+2);
+        if (pthread_create(&workers[i].thread, NULL, worker, &workers[i])) {
+            fprintf(stderr, "cannot start thread %u\n", i);
+            exit(1);
+        }
+    }
+
+    /* Merge per-thread histograms */
+    for (i=0; i<nthreads; i++) {
+        unsigned int b;
+        pthread_join(workers[i].thread, NULL);
+        for (op=0; op<NOPS; op++) {
+            for (b=0; b<HIST_BUCKETS; b++) hist[op].bucket[b] += workers[i].hist[op].bucket[b];
+            hist[op].count += workers[i].hist[op].count;
+            if (workers[i].hist[op].max > hist[op].max) hist[op].max = workers[i].hist[op].max;
+        }
+        failures += workers[i].failures;
+        elapsed += workers[i].elapsed / nthreads;
+    }
+    for (op=0; op<NOPS; op++) total_count += hist[op].count;
+
+    if (json) {
+        printf("{\"threads\": %u, \"seconds\": %.3f, \"keys\": %u, \"verify\": \"%s\", "
+            "\"ops_per_sec\": %.1f, \"failures\": %lu, \"results\": [",
+            nthreads, elapsed, nkeys, verify_names[verify_mode],
+            total_count/elapsed, (unsigned long)failures);
+    } else {
+        printf("# %u threads, %.2f s, %u keys, verify by %s, %.0f ops/s, %lu failures\n",
+            nthreads, elapsed, nkeys, verify_names[verify_mode],
+            total_count/elapsed, (unsigned long)failures);
+        printf("%-8s %10s %11s %10s %10s %10s %10s\n",
+            "op", "count", "ops/s", "p50 us", "p99 us", "p999 us", "max us");
+    }
+
+    for (op=0; op<NOPS; op++) {
+        const hist_t *h = &hist[op];
+        if (!mix[op]) continue;
+        if (json) {
+            printf("%s\n  {\"op\": \"%s\", \"count\": %lu, \"ops_per_sec\": %.1f, \"p50_us\": %.2f, "
+                "\"p99_us\": %.2f, \"p999_us\": %.2f, \"max_us\": %.2f}",
+                first ? "" : ",", op_names[op], (unsigned long)h->count, h->count/elapsed,
+                hist_percentile(h, 0.5)/1e3, hist_percentile(h, 0.99)/1e3,
+                hist_percentile(h, 0.999)/1e3, h->max/1e3);
+        } else {
+            printf("%-8s %10lu %11.0f %10.1f %10.1f %10.1f %10.1f\n",
+                op_names[op], (unsigned long)h->count, h->count/elapsed,
+                hist_percentile(h, 0.5)/1e3, hist_percentile(h, 0.99)/1e3,
+                hist_percentile(h, 0.999)/1e3, h->max/1e3);
+        }
+        first = 0;
+    }
+    if (json) printf("\n]}\n");
+
+    ristretto255_key_cache_free(cache);
+    for (i=0; i<nkeys; i++) free(keys[i].table);
+    free(keys);
+    free(workers);
+    free(hist);
+    pthread_barrier_destroy(&start_barrier);
+    return failures != 0;
+}
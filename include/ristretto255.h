@@ -149,6 +149,53 @@ typedef struct {
     /** @endcond */
 } ristretto255_point_t;
 
+/**
+ * A point prepared for adding to others, in projective Niels coordinates.
+ * Adding one takes a multiply less than ristretto255_point_add, which
+ * recomputes them for its second argument each time.
+ */
+typedef struct {
+    /** @cond internal */
+    gf_25519_t a,b,c,z; /* y-x, y+x, 2dt, 2z */
+    /** @endcond */
+} ristretto255_point_cached_t;
+
+/**
+ * A cached point normalized to z=1, with ristretto255_point_cached_normalize.
+ * Adding one takes two multiplies less than ristretto255_point_add.
+ */
+typedef struct {
+    /** @cond internal */
+    gf_25519_t a,b,c; /* Those of the cached point, over its z */
+    /** @endcond */
+} ristretto255_point_affine_cached_t;
+
+/** Cached points normalized per field inversion by ristretto255_point_cached_normalize. */
+#define RISTRETTO255_CACHED_NORMALIZE_BATCH 64
+
+/** Number of points in a ristretto255_point_block_t. */
+#define RISTRETTO255_POINT_BLOCK_LANES 4
+
+/**
+ * Four points, stored limb by limb: limb i of the x-coordinate of point j
+ * is x[i][j], and likewise for y, z and t.  An array of blocks holds an
+ * array of points so that a vector unit loads one limb of four points at
+ * once, without shuffles.  Convert with ristretto255_point_block_load and
+ * ristretto255_point_block_store.
+ */
+typedef struct {
+    /** @cond internal */
+    ristretto_word_t x[RISTRETTO255_FIELD_LIMBS][RISTRETTO255_POINT_BLOCK_LANES];
+    ristretto_word_t y[RISTRETTO255_FIELD_LIMBS][RISTRETTO255_POINT_BLOCK_LANES];
+    ristretto_word_t z[RISTRETTO255_FIELD_LIMBS][RISTRETTO255_POINT_BLOCK_LANES];
+    ristretto_word_t t[RISTRETTO255_FIELD_LIMBS][RISTRETTO255_POINT_BLOCK_LANES];
+    /** @endcond */
+} __attribute__((aligned(32))) ristretto255_point_block_t;
+
+/** The number of blocks which hold n points. */
+#define RISTRETTO255_POINT_BLOCKS(n) \
+    (((n)+RISTRETTO255_POINT_BLOCK_LANES-1)/RISTRETTO255_POINT_BLOCK_LANES)
+
 /** Precomputed table based on a point.  Can be trivial implementation. */
 struct ristretto255_precomputed_s;
 
@@ -158,6 +205,35 @@ typedef struct ristretto255_precomputed_s ristretto255_precomputed_s;
 /** Size and alignment of precomputed point tables. */
 extern const size_t ristretto255_sizeof_precomputed_s, ristretto255_alignof_precomputed_s;
 
+/** Operations that can run in a caller-provided workspace. */
+typedef enum {
+    RISTRETTO255_WS_PRECOMPUTE_BATCH = 1, /**< ristretto255_precompute_batch_ws */
+    RISTRETTO255_WS_KEY_CACHE = 2         /**< The ristretto255_key_cache_*_ws functions */
+} ristretto255_workspace_op_t;
+
+/**
+ * @brief Size of the workspace that an operation needs for n inputs.
+ *
+ * Workspaces must be aligned to ristretto255_alignof_precomputed_s.
+ * The operation zeroizes its workspace when it is done, and may reuse
+ * it for the next call.
+ *
+ * @return The size in bytes, or 0 if op is unknown or the size overflows.
+ */
+size_t ristretto255_workspace_size (
+    ristretto255_workspace_op_t op,
+    size_t n
+) RISTRETTO_WARN_UNUSED;
+
+/** Table of odd multiples of a point, for variable-time scalarmul. */
+struct ristretto255_precomputed_wnaf_s;
+
+/** Table of odd multiples of a point, for variable-time scalarmul. */
+typedef struct ristretto255_precomputed_wnaf_s ristretto255_precomputed_wnaf_s;
+
+/** Size of wNAF tables.  Their alignment is ristretto255_alignof_precomputed_s. */
+extern const size_t ristretto255_sizeof_precomputed_wnaf_s;
+
 /** Representation of an element of the scalar field. */
 typedef struct {
     /** @cond internal */
@@ -333,6 +409,58 @@ void ristretto255_scalar_set_unsigned (
     uint64_t a
 ) RISTRETTO_NONNULL;
 
+/**
+ * @brief Multiply two arrays of scalars elementwise: out[i] = a[i]*b[i].
+ *
+ * Equivalent to n calls to ristretto255_scalar_mul, but processes four
+ * scalars at a time when vector instructions are available.  Each output
+ * may be the same as the corresponding input, but the arrays must not
+ * otherwise overlap.
+ *
+ * @param [out] out The n products.
+ * @param [in] a The n first factors.
+ * @param [in] b The n second factors.
+ * @param [in] n The number of scalars in each array.
+ */
+void ristretto255_scalar_mul_batch (
+    ristretto255_scalar_t *out,
+    const ristretto255_scalar_t *a,
+    const ristretto255_scalar_t *b,
+    size_t n
+) RISTRETTO_NONNULL RISTRETTO_NOINLINE;
+
+/**
+ * @brief Add two arrays of scalars elementwise: out[i] = a[i]+b[i].
+ * Aliasing rules are as for ristretto255_scalar_mul_batch.
+ *
+ * @param [out] out The n sums.
+ * @param [in] a The n first addends.
+ * @param [in] b The n second addends.
+ * @param [in] n The number of scalars in each array.
+ */
+void ristretto255_scalar_add_batch (
+    ristretto255_scalar_t *out,
+    const ristretto255_scalar_t *a,
+    const ristretto255_scalar_t *b,
+    size_t n
+) RISTRETTO_NONNULL RISTRETTO_NOINLINE;
+
+/**
+ * @brief Subtract two arrays of scalars elementwise: out[i] = a[i]-b[i].
+ * Aliasing rules are as for ristretto255_scalar_mul_batch.
+ *
+ * @param [out] out The n differences.
+ * @param [in] a The n minuends.
+ * @param [in] b The n subtrahends.
+ * @param [in] n The number of scalars in each array.
+ */
+void ristretto255_scalar_sub_batch (
+    ristretto255_scalar_t *out,
+    const ristretto255_scalar_t *a,
+    const ristretto255_scalar_t *b,
+    size_t n
+) RISTRETTO_NONNULL RISTRETTO_NOINLINE;
+
 /**
  * @brief Encode a point as a sequence of bytes.
  *
@@ -446,6 +574,227 @@ void ristretto255_point_negate (
    const ristretto255_point_t *a
 ) RISTRETTO_NONNULL;
 
+/**
+ * @brief Prepare a point for repeated addition.
+ *
+ * @param [out] cached The point, cached.
+ * @param [in] a The point.
+ */
+void ristretto255_point_to_cached (
+    ristretto255_point_cached_t *cached,
+    const ristretto255_point_t *a
+) RISTRETTO_NONNULL;
+
+/**
+ * @brief Add a cached point to a point.  The input and output points
+ * can use the same memory.
+ *
+ * @param [out] sum The sum a+b.
+ * @param [in] a A point.
+ * @param [in] b A cached point.
+ */
+void ristretto255_point_add_cached (
+    ristretto255_point_t *sum,
+    const ristretto255_point_t *a,
+    const ristretto255_point_cached_t *b
+) RISTRETTO_NONNULL;
+
+/**
+ * @brief Subtract a cached point from a point.  The input and output
+ * points can use the same memory.
+ *
+ * @param [out] diff The difference a-b.
+ * @param [in] a The minuend.
+ * @param [in] b The cached subtrahend.
+ */
+void ristretto255_point_sub_cached (
+    ristretto255_point_t *diff,
+    const ristretto255_point_t *a,
+    const ristretto255_point_cached_t *b
+) RISTRETTO_NONNULL;
+
+/**
+ * @brief Normalize n cached points to z=1, sharing an inversion between
+ * up to RISTRETTO255_CACHED_NORMALIZE_BATCH of them.  This pays once each
+ * point is added more than a few times.
+ *
+ * @param [out] out The normalized points.
+ * @param [in] in The cached points.
+ * @param [in] n The number of points.
+ */
+void ristretto255_point_cached_normalize (
+    ristretto255_point_affine_cached_t *out,
+    const ristretto255_point_cached_t *in,
+    size_t n
+) RISTRETTO_NONNULL;
+
+/**
+ * @brief Add a normalized cached point to a point.  The input and output
+ * points can use the same memory.
+ *
+ * @param [out] sum The sum a+b.
+ * @param [in] a A point.
+ * @param [in] b A normalized cached point.
+ */
+void ristretto255_point_add_affine_cached (
+    ristretto255_point_t *sum,
+    const ristretto255_point_t *a,
+    const ristretto255_point_affine_cached_t *b
+) RISTRETTO_NONNULL;
+
+/**
+ * @brief Subtract a normalized cached point from a point.  The input and
+ * output points can use the same memory.
+ *
+ * @param [out] diff The difference a-b.
+ * @param [in] a The minuend.
+ * @param [in] b The normalized cached subtrahend.
+ */
+void ristretto255_point_sub_affine_cached (
+    ristretto255_point_t *diff,
+    const ristretto255_point_t *a,
+    const ristretto255_point_affine_cached_t *b
+) RISTRETTO_NONNULL;
+
+/**
+ * @brief Sum n points, as a chain of ristretto255_point_add.
+ *
+ * The points are added into several independent accumulators, which are
+ * summed at the end, and split across threads.
+ *
+ * @param [out] sum The sum of the points, or the identity if n is 0.
+ * @param [in] points The points.
+ * @param [in] n The number of points.
+ * @param [in] threads The number of threads to use, including the
+ * calling thread.  0 or 1 uses only the calling thread.
+ */
+void ristretto255_point_sum (
+    ristretto255_point_t *sum,
+    const ristretto255_point_t *points,
+    size_t n,
+    unsigned int threads
+) RISTRETTO_NONNULL RISTRETTO_NOINLINE;
+
+/**
+ * @brief Decode n points and sum them, as ristretto255_point_decode and
+ * ristretto255_point_sum.
+ *
+ * Decoded points have z=1, so each costs a mixed addition rather than a
+ * full one, and the inverse square roots of decoding are shared in small
+ * batches.
+ *
+ * @param [out] sum The sum of the points.  If any fails to decode, the
+ * identity.
+ * @param [in] ser The n encodings, RISTRETTO255_SER_BYTES each.
+ * @param [in] n The number of points.
+ * @param [in] allow_identity Allow the identity to be decoded.
+ * @param [in] threads The number of threads to use, including the
+ * calling thread.  0 or 1 uses only the calling thread.
+ *
+ * @retval RISTRETTO_SUCCESS Every encoding decoded.
+ * @retval RISTRETTO_FAILURE At least one encoding failed to decode.
+ */
+ristretto_error_t ristretto255_point_decode_sum (
+    ristretto255_point_t *sum,
+    const unsigned char *ser,
+    size_t n,
+    ristretto_bool_t allow_identity,
+    unsigned int threads
+) RISTRETTO_WARN_UNUSED RISTRETTO_NONNULL RISTRETTO_NOINLINE;
+
+/**
+ * @brief Pack n points into RISTRETTO255_POINT_BLOCKS(n) blocks.  Lanes
+ * of the last block past n are set to the identity.
+ *
+ * @param [out] blocks The points, in blocks.
+ * @param [in] points The points to pack.
+ * @param [in] n The number of points.
+ */
+void ristretto255_point_block_load (
+    ristretto255_point_block_t *blocks,
+    const ristretto255_point_t *points,
+    size_t n
+) RISTRETTO_NONNULL;
+
+/**
+ * @brief Unpack the first n points of an array of blocks.
+ *
+ * @param [out] points The n points.
+ * @param [in] blocks The blocks holding them.
+ * @param [in] n The number of points.
+ */
+void ristretto255_point_block_store (
+    ristretto255_point_t *points,
+    const ristretto255_point_block_t *blocks,
+    size_t n
+) RISTRETTO_NONNULL;
+
+/**
+ * @brief Add n pairs of points held in blocks, as n calls to
+ * ristretto255_point_add.  The inputs and output may alias.
+ *
+ * @param [out] sum The sums a[i]+b[i].
+ * @param [in] a The first addends.
+ * @param [in] b The second addends.
+ * @param [in] n The number of points.
+ */
+void ristretto255_point_block_add (
+    ristretto255_point_block_t *sum,
+    const ristretto255_point_block_t *a,
+    const ristretto255_point_block_t *b,
+    size_t n
+) RISTRETTO_NONNULL;
+
+/**
+ * @brief Double n points held in blocks, as n calls to
+ * ristretto255_point_double.  The input and output may alias.
+ *
+ * @param [out] two_a The doubles a[i]+a[i].
+ * @param [in] a The points.
+ * @param [in] n The number of points.
+ */
+void ristretto255_point_block_double (
+    ristretto255_point_block_t *two_a,
+    const ristretto255_point_block_t *a,
+    size_t n
+) RISTRETTO_NONNULL;
+
+/**
+ * @brief Encode n points held in blocks, as n calls to
+ * ristretto255_point_encode.  The inverse square roots are shared.
+ *
+ * @param [out] ser n consecutive encodings.
+ * @param [in] blocks The points.
+ * @param [in] n The number of points.
+ */
+void ristretto255_point_block_encode (
+    uint8_t *ser,
+    const ristretto255_point_block_t *blocks,
+    size_t n
+) RISTRETTO_NONNULL;
+
+/**
+ * @brief Decode n points into RISTRETTO255_POINT_BLOCKS(n) blocks, each
+ * as ristretto255_point_decode.  The inverse square roots are shared.
+ * Points which fail to decode, and lanes past n, are set to the identity.
+ *
+ * @param [out] blocks The decoded points.
+ * @param [out] success Per point, RISTRETTO_TRUE if it decoded.
+ * @param [in] ser n consecutive encodings.
+ * @param [in] n The number of points.
+ * @param [in] allow_identity RISTRETTO_TRUE if the identity is a legal input.
+ *
+ * @retval RISTRETTO_SUCCESS Every point decoded.
+ * @retval RISTRETTO_FAILURE At least one point did not.
+ */
+ristretto_error_t ristretto255_point_block_decode (
+    ristretto255_point_block_t *blocks,
+    ristretto_bool_t *success,
+    const uint8_t *ser,
+    size_t n,
+    ristretto_bool_t allow_identity
+) RISTRETTO_NONNULL;
+
 /**
  * @brief Multiply a base point by a scalar: scaled = scalar*base.
  *
@@ -484,6 +833,32 @@ ristretto_error_t ristretto255_direct_scalarmul (
     ristretto_bool_t short_circuit
 ) RISTRETTO_NONNULL RISTRETTO_WARN_UNUSED RISTRETTO_NOINLINE;
 
+/**
+ * @brief Multiply n serialized base points by one scalar, each exactly as
+ * ristretto255_direct_scalarmul without short-circuiting.  The scalar is
+ * recoded once, several bases are multiplied in an interleaved pipeline,
+ * and the decodes and encodes share inverse square roots.
+ *
+ * @param [out] scaled n encodings of scalar*base.  As for the single-point
+ * function, a base that fails to decode is replaced by the generator.
+ * @param [out] success Per base, RISTRETTO_TRUE if it decoded.
+ * @param [in] bases n encoded points to be scaled.
+ * @param [in] scalar The scalar to multiply by.
+ * @param [in] n The number of bases.
+ * @param [in] allow_identity Allow the inputs to be the identity.
+ *
+ * @retval RISTRETTO_SUCCESS Every base decoded.
+ * @retval RISTRETTO_FAILURE At least one base did not.
+ */
+ristretto_error_t ristretto255_direct_scalarmul_fanout (
+    uint8_t *scaled,
+    ristretto_bool_t *success,
+    const uint8_t *bases,
+    const ristretto255_scalar_t *scalar,
+    size_t n,
+    ristretto_bool_t allow_identity
+) RISTRETTO_NONNULL RISTRETTO_WARN_UNUSED RISTRETTO_NOINLINE;
+
 /**
  * @brief Precompute a table for fast scalar multiplication.
  * Some implementations do not include precomputed points; for
@@ -498,6 +873,45 @@ void ristretto255_precompute (
     const ristretto255_point_t *b
 ) RISTRETTO_NONNULL RISTRETTO_NOINLINE;
 
+/**
+ * @brief Precompute tables for many points, as n calls to
+ * ristretto255_precompute.
+ *
+ * The tables are normalized together, with one field inversion per
+ * small batch of points instead of one per point, and the points are
+ * split across threads.
+ *
+ * @param [out] tables A contiguous array of n tables, each
+ * ristretto255_sizeof_precomputed_s bytes.
+ * @param [in] bases The points.
+ * @param [in] n The number of points.
+ * @param [in] threads The number of threads to use, including the
+ * calling thread.  0 or 1 uses only the calling thread.
+ */
+void ristretto255_precompute_batch (
+    ristretto255_precomputed_s *tables,
+    const ristretto255_point_t *bases,
+    size_t n,
+    unsigned int threads
+) RISTRETTO_NONNULL RISTRETTO_NOINLINE;
+
+/**
+ * @brief As ristretto255_precompute_batch on one thread, but normalizing
+ * all n tables with a single field inversion, using a workspace of
+ * ristretto255_workspace_size(RISTRETTO255_WS_PRECOMPUTE_BATCH, n) bytes.
+ *
+ * @param [out] tables A contiguous array of n tables.
+ * @param [in] bases The points.
+ * @param [in] n The number of points.
+ * @param [in] workspace Scratch space, zeroized on return.
+ */
+void ristretto255_precompute_batch_ws (
+    ristretto255_precomputed_s *tables,
+    const ristretto255_point_t *bases,
+    size_t n,
+    void *workspace
+) RISTRETTO_NONNULL RISTRETTO_NOINLINE;
+
 /**
  * @brief Multiply a precomputed base point by a scalar:
  * scaled = scalar*base.
@@ -536,6 +950,76 @@ void ristretto255_point_double_scalarmul (
     const ristretto255_scalar_t *scalar2
 ) RISTRETTO_NONNULL RISTRETTO_NOINLINE;
 
+/**
+ * @brief Multiply a base point by a public scalar: scaled = scalar*base.
+ *
+ * Otherwise equivalent to ristretto255_point_scalarmul, but faster at the
+ * expense of being variable time.
+ *
+ * @param [out] scaled The scaled point base*scalar.  It may be the same
+ * as the base.
+ * @param [in] base The point to be scaled.
+ * @param [in] scalar The scalar to multiply by.
+ *
+ * @warning: This function takes variable time, and may leak the scalar
+ * used.
+ */
+void ristretto255_point_scalarmul_non_secret (
+    ristretto255_point_t *scaled,
+    const ristretto255_point_t *base,
+    const ristretto255_scalar_t *scalar
+) RISTRETTO_NONNULL RISTRETTO_NOINLINE;
+
+/**
+ * @brief Precompute a table of odd multiples of a point, for repeated
+ * variable-time multiplication of that point by public scalars.
+ *
+ * @param [out] table The table of multiples.
+ * @param [in] base Any point.
+ */
+void ristretto255_precompute_wnaf (
+    ristretto255_precomputed_wnaf_s *table,
+    const ristretto255_point_t *base
+) RISTRETTO_NONNULL RISTRETTO_NOINLINE;
+
+/**
+ * @brief Multiply a point by a public scalar, using its wNAF table.
+ *
+ * Equivalent to ristretto255_point_scalarmul_non_secret, but skips
+ * building the table.
+ *
+ * @param [out] scaled The scaled point base*scalar.
+ * @param [in] base A table from ristretto255_precompute_wnaf.
+ * @param [in] scalar The scalar to multiply by.
+ *
+ * @warning: This function takes variable time, and may leak the scalar
+ * used.
+ */
+void ristretto255_precomputed_wnaf_scalarmul_non_secret (
+    ristretto255_point_t *scaled,
+    const ristretto255_precomputed_wnaf_s *base,
+    const ristretto255_scalar_t *scalar
+) RISTRETTO_NONNULL RISTRETTO_NOINLINE;
+
+/**
+ * @brief As ristretto255_base_double_scalarmul_non_secret, but using
+ * base2's wNAF table: combo = scalar1*base + scalar2*base2.
+ *
+ * @param [out] combo The linear combination scalar1*base + scalar2*base2.
+ * @param [in] scalar1 A first scalar to multiply by.
+ * @param [in] base2 A table from ristretto255_precompute_wnaf.
+ * @param [in] scalar2 A second scalar to multiply by.
+ *
+ * @warning: This function takes variable time, and may leak the scalars
+ * used.
+ */
+void ristretto255_precomputed_wnaf_base_double_scalarmul_non_secret (
+    ristretto255_point_t *combo,
+    const ristretto255_scalar_t *scalar1,
+    const ristretto255_precomputed_wnaf_s *base2,
+    const ristretto255_scalar_t *scalar2
+) RISTRETTO_NONNULL RISTRETTO_NOINLINE;
+
 /**
  * Multiply one base point by two scalars:
  *
@@ -559,6 +1043,65 @@ void ristretto255_point_dual_scalarmul (
     const ristretto255_scalar_t *scalar2
 ) RISTRETTO_NONNULL RISTRETTO_NOINLINE;
 
+/**
+ * Multiply one base point by n scalars: scaled[i] = scalars[i] * base.
+ *
+ * Equivalent to n calls to ristretto255_point_scalarmul, but the doublings
+ * of the base are computed once and shared, so it is faster for n > 1.
+ *
+ * @param [out] scaled The n multiples.  One of them may be the base.
+ * @param [in] base The point to be scaled.
+ * @param [in] scalars The n scalars to multiply by.
+ * @param [in] n The number of scalars.
+ */
+void ristretto255_point_scalarmul_multiples (
+    ristretto255_point_t *scaled,
+    const ristretto255_point_t *base,
+    const ristretto255_scalar_t *scalars,
+    size_t n
+) RISTRETTO_NONNULL RISTRETTO_NOINLINE;
+
+/**
+ * @brief Multiply one base point by n public scalars:
+ * scaled[i] = scalars[i] * base.
+ *
+ * Otherwise equivalent to ristretto255_point_scalarmul_multiples, but
+ * faster at the expense of being variable time.
+ *
+ * @param [out] scaled The n multiples.  One of them may be the base.
+ * @param [in] base The point to be scaled.
+ * @param [in] scalars The n scalars to multiply by.
+ * @param [in] n The number of scalars.
+ *
+ * @warning: This function takes variable time, and may leak the scalars
+ * used.
+ */
+void ristretto255_point_scalarmul_multiples_non_secret (
+    ristretto255_point_t *scaled,
+    const ristretto255_point_t *base,
+    const ristretto255_scalar_t *scalars,
+    size_t n
+) RISTRETTO_NONNULL RISTRETTO_NOINLINE;
+
+/**
+ * @brief Multiply the base point by a public scalar:
+ * scaled = scalar*ristretto255_point_base.
+ *
+ * Otherwise equivalent to ristretto255_precomputed_scalarmul with
+ * ristretto255_precomputed_base, but faster at the expense of being
+ * variable time.
+ *
+ * @param [out] scaled The scaled point scalar*base.
+ * @param [in] scalar The scalar to multiply by.
+ *
+ * @warning: This function takes variable time, and may leak the scalar
+ * used.
+ */
+void ristretto255_base_scalarmul_non_secret (
+    ristretto255_point_t *scaled,
+    const ristretto255_scalar_t *scalar
+) RISTRETTO_NONNULL RISTRETTO_NOINLINE;
+
 /**
  * @brief Multiply two base points by two scalars:
  * scaled = scalar1*ristretto255_point_base + scalar2*base2.
@@ -697,6 +1240,25 @@ void ristretto255_point_from_hash_uniform (
     const unsigned char hashed_data[2*RISTRETTO255_HASH_BYTES]
 ) RISTRETTO_NONNULL RISTRETTO_NOINLINE;
 
+/**
+ * @brief Hash many inputs to the curve at once.
+ *
+ * Equivalent to n calls to ristretto255_point_from_hash_uniform, but
+ * faster: the inverse square roots of the 2n Elligator evaluations are
+ * computed several at a time in vector lanes where available.  Each
+ * evaluation is still constant-time in its input.
+ *
+ * @param [in] hashed_data n consecutive outputs of some hash function,
+ * each 2*RISTRETTO255_HASH_BYTES long.
+ * @param [out] pts The n points.
+ * @param [in] n The number of inputs.
+ */
+void ristretto255_point_from_hash_uniform_batch (
+    ristretto255_point_t *pts,
+    const unsigned char *hashed_data,
+    size_t n
+) RISTRETTO_NONNULL RISTRETTO_NOINLINE;
+
 /**
  * @brief Inverse of elligator-like hash to curve.
  *
@@ -755,6 +1317,588 @@ ristretto_error_t ristretto255_invert_elligator_uniform (
     uint32_t which
 ) RISTRETTO_NONNULL RISTRETTO_NOINLINE RISTRETTO_WARN_UNUSED;
 
+/**
+ * @brief Every Elligator inverse of a point at once.
+ *
+ * Equivalent to calling ristretto255_invert_elligator_nonuniform for each
+ * "which" value, but the work they share is done once: a single
+ * deisogenization, and one inverse square root for each of the 8
+ * combinations of hint bits that affect it, computed together.
+ *
+ * @param [out] recovered_hashes Encoded data, indexed by "which".
+ * @param [in] pt The point to encode.
+ *
+ * @return A mask with bit "which" set if recovered_hashes[which] is a
+ * preimage, exactly when ristretto255_invert_elligator_nonuniform would
+ * succeed for that value.
+ */
+uint32_t ristretto255_invert_elligator_nonuniform_all (
+    unsigned char recovered_hashes[1<<RISTRETTO255_INVERT_ELLIGATOR_WHICH_BITS][RISTRETTO255_HASH_BYTES],
+    const ristretto255_point_t *pt
+) RISTRETTO_NONNULL RISTRETTO_NOINLINE RISTRETTO_WARN_UNUSED;
+
+/**
+ * @brief Every uniform Elligator inverse of a point at once.
+ *
+ * Equivalent to copying partial_hash into the second half of a buffer and
+ * calling ristretto255_invert_elligator_uniform on it for each "which"
+ * value.  To encode a point uniformly, pick partial_hash at random, then
+ * pick a set bit of the result at random; retry if there is none.
+ *
+ * @param [out] recovered_hashes Encoded data, indexed by "which".
+ * @param [in] pt The point to encode.
+ * @param [in] partial_hash The second half of each encoding.
+ *
+ * @return A mask with bit "which" set if recovered_hashes[which] is a
+ * preimage.
+ */
+uint32_t ristretto255_invert_elligator_uniform_all (
+    unsigned char recovered_hashes[1<<RISTRETTO255_INVERT_ELLIGATOR_WHICH_BITS][2*RISTRETTO255_HASH_BYTES],
+    const ristretto255_point_t *pt,
+    const unsigned char partial_hash[RISTRETTO255_HASH_BYTES]
+) RISTRETTO_NONNULL RISTRETTO_NOINLINE RISTRETTO_WARN_UNUSED;
+
+/**
+ * @brief Uniform Elligator inverses of n points, each exactly as
+ * ristretto255_invert_elligator_uniform with its own hint.  The three
+ * inverse square roots each inverse needs are computed for several points
+ * at a time, so this is much faster than a loop.
+ *
+ * Failures are independent per point: the caller can choose fresh second
+ * halves or hints for just the points that failed and call again on those.
+ *
+ * @param [inout] recovered_hashes n encodings of 2*RISTRETTO255_HASH_BYTES.
+ * As for the single-point function, the second half of each is an input.
+ * @param [out] success Per point, RISTRETTO_TRUE if its inverse succeeded.
+ * @param [in] pts The n points to encode.
+ * @param [in] hints The n "which" values, one byte each.
+ * @param [in] n The number of points.
+ *
+ * @retval RISTRETTO_SUCCESS Every inverse succeeded.
+ * @retval RISTRETTO_FAILURE At least one inverse failed.
+ */
+ristretto_error_t ristretto255_invert_elligator_uniform_batch (
+    unsigned char *recovered_hashes,
+    ristretto_bool_t *success,
+    const ristretto255_point_t *pts,
+    const unsigned char *hints,
+    size_t n
+) RISTRETTO_NONNULL RISTRETTO_NOINLINE RISTRETTO_WARN_UNUSED;
+
+/** Number of bytes in a SHA-512 block. */
+#define RISTRETTO255_SHA512_BLOCK_BYTES 128
+
+/** Number of bytes in a SHA-512 output. */
+#define RISTRETTO255_SHA512_OUTPUT_BYTES 64
+
+/** Incremental SHA-512 state. */
+typedef struct ristretto255_sha512_ctx_s {
+    /** @cond internal */
+    uint64_t state[8];
+    uint8_t block[RISTRETTO255_SHA512_BLOCK_BYTES];
+    uint64_t bytes_processed;
+    /** @endcond */
+} ristretto255_sha512_ctx_t;
+
+/**
+ * @brief Initialize a SHA-512 context.
+ * @param [out] ctx The context.
+ */
+void ristretto255_sha512_init (
+    ristretto255_sha512_ctx_t *ctx
+) RISTRETTO_NONNULL RISTRETTO_NOINLINE;
+
+/**
+ * @brief Absorb part of a message into a SHA-512 context.
+ * @param [inout] ctx The context.
+ * @param [in] message The message fragment.
+ * @param [in] message_len The length of the fragment in bytes.
+ */
+void ristretto255_sha512_update (
+    ristretto255_sha512_ctx_t *ctx,
+    const uint8_t *message,
+    size_t message_len
+) RISTRETTO_NONNULL RISTRETTO_NOINLINE;
+
+/**
+ * @brief Finish a SHA-512 hash and erase the context.
+ * @param [inout] ctx The context.
+ * @param [out] out The hash.
+ */
+void ristretto255_sha512_final (
+    ristretto255_sha512_ctx_t *ctx,
+    uint8_t out[RISTRETTO255_SHA512_OUTPUT_BYTES]
+) RISTRETTO_NONNULL RISTRETTO_NOINLINE;
+
+/**
+ * @brief Hash a message with SHA-512 in one call.
+ * @param [out] out The hash.
+ * @param [in] message The message.
+ * @param [in] message_len The length of the message in bytes.
+ */
+void ristretto255_sha512_hash (
+    uint8_t out[RISTRETTO255_SHA512_OUTPUT_BYTES],
+    const uint8_t *message,
+    size_t message_len
+) RISTRETTO_NONNULL RISTRETTO_NOINLINE;
+
+/** Longest domain separation tag used as-is by expand_message_xmd.
+ * Longer tags are first hashed down, as RFC 9380 specifies.
+ */
+#define RISTRETTO255_HASH_DST_MAX_BYTES 255
+
+/**
+ * A domain separation tag, prepared once for any number of
+ * ristretto255_hash_* calls.
+ */
+typedef struct ristretto255_hash_dst_s {
+    /** @cond internal */
+    uint8_t dst_prime[RISTRETTO255_HASH_DST_MAX_BYTES+1]; /* DST || I2OSP(len(DST), 1) */
+    uint16_t dst_prime_len;
+    /** @endcond */
+} ristretto255_hash_dst_t;
+
+/** Incremental state of expand_message_xmd with SHA-512. */
+typedef struct ristretto255_hash_s {
+    /** @cond internal */
+    ristretto255_sha512_ctx_t sha;
+    const ristretto255_hash_dst_t *dst;
+    /** @endcond */
+} ristretto255_hash_t;
+
+/**
+ * @brief Prepare a domain separation tag.
+ *
+ * Tags longer than RISTRETTO255_HASH_DST_MAX_BYTES are replaced by
+ * SHA-512("H2C-OVERSIZE-DST-" || tag), per RFC 9380 section 5.3.3.
+ *
+ * @param [out] dst The prepared tag.
+ * @param [in] tag The domain separation tag.
+ * @param [in] tag_len The length of the tag in bytes.
+ */
+void ristretto255_hash_dst_init (
+    ristretto255_hash_dst_t *dst,
+    const uint8_t *tag,
+    size_t tag_len
+) RISTRETTO_NONNULL RISTRETTO_NOINLINE;
+
+/**
+ * @brief Start hashing a message with expand_message_xmd (RFC 9380) and SHA-512.
+ *
+ * The all-zero first block is the same for every message, so the context
+ * starts from a precomputed state and never hashes it.  The dst must stay
+ * valid until the hash is finished.
+ *
+ * @param [out] ctx The hash context.
+ * @param [in] dst The prepared domain separation tag.
+ */
+void ristretto255_hash_init (
+    ristretto255_hash_t *ctx,
+    const ristretto255_hash_dst_t *dst
+) RISTRETTO_NONNULL RISTRETTO_NOINLINE;
+
+/**
+ * @brief Absorb part of a message.  Messages may be streamed in any number
+ * of fragments, and are not buffered beyond one SHA-512 block.
+ *
+ * @param [inout] ctx The hash context.
+ * @param [in] message The message fragment.
+ * @param [in] message_len The length of the fragment in bytes.
+ */
+void ristretto255_hash_update (
+    ristretto255_hash_t *ctx,
+    const uint8_t *message,
+    size_t message_len
+) RISTRETTO_NONNULL RISTRETTO_NOINLINE;
+
+/**
+ * @brief Finish expand_message_xmd, producing out_len uniform bytes, and
+ * erase the context.
+ *
+ * @param [inout] ctx The hash context.
+ * @param [out] out The uniform bytes.
+ * @param [in] out_len The number of bytes to produce, at most 255*64.
+ *
+ * @retval RISTRETTO_SUCCESS The bytes were produced.
+ * @retval RISTRETTO_FAILURE out_len is too long.
+ */
+ristretto_error_t ristretto255_hash_final (
+    ristretto255_hash_t *ctx,
+    uint8_t *out,
+    size_t out_len
+) RISTRETTO_NONNULL RISTRETTO_NOINLINE RISTRETTO_WARN_UNUSED;
+
+/**
+ * @brief Finish hashing to a group element, as hash_to_group in RFC 9496:
+ * 64 bytes of expand_message_xmd fed to ristretto255_point_from_hash_uniform.
+ *
+ * @param [out] pt The resulting point.
+ * @param [inout] ctx The hash context, which is erased.
+ */
+void ristretto255_hash_final_to_group (
+    ristretto255_point_t *pt,
+    ristretto255_hash_t *ctx
+) RISTRETTO_NONNULL RISTRETTO_NOINLINE;
+
+/**
+ * @brief Finish hashing to a scalar: 64 bytes of expand_message_xmd,
+ * reduced mod the group order.
+ *
+ * @param [out] out The resulting scalar.
+ * @param [inout] ctx The hash context, which is erased.
+ */
+void ristretto255_hash_final_to_scalar (
+    ristretto255_scalar_t *out,
+    ristretto255_hash_t *ctx
+) RISTRETTO_NONNULL RISTRETTO_NOINLINE;
+
+/**
+ * @brief Hash a message to a group element in one call.
+ *
+ * @param [out] pt The resulting point.
+ * @param [in] message The message.
+ * @param [in] message_len The length of the message in bytes.
+ * @param [in] dst The prepared domain separation tag.
+ */
+void ristretto255_hash_to_group (
+    ristretto255_point_t *pt,
+    const uint8_t *message,
+    size_t message_len,
+    const ristretto255_hash_dst_t *dst
+) RISTRETTO_NONNULL RISTRETTO_NOINLINE;
+
+/**
+ * @brief Hash a message to a scalar in one call.
+ *
+ * @param [out] out The resulting scalar.
+ * @param [in] message The message.
+ * @param [in] message_len The length of the message in bytes.
+ * @param [in] dst The prepared domain separation tag.
+ */
+void ristretto255_hash_to_scalar (
+    ristretto255_scalar_t *out,
+    const uint8_t *message,
+    size_t message_len,
+    const ristretto255_hash_dst_t *dst
+) RISTRETTO_NONNULL RISTRETTO_NOINLINE;
+
+/**
+ * @brief Hash n messages to group elements, exactly as n calls to
+ * ristretto255_hash_to_group with the same DST.  The expand_message_xmd
+ * hashes run several messages at a time on the vector unit, and each group
+ * of outputs is mapped with ristretto255_point_from_hash_uniform_batch.
+ *
+ * @param [out] pts The n resulting points.
+ * @param [in] messages The n messages.
+ * @param [in] message_lens Their lengths in bytes.
+ * @param [in] n The number of messages.
+ * @param [in] dst The domain separation tag, from ristretto255_hash_dst_init.
+ */
+void ristretto255_hash_to_group_batch (
+    ristretto255_point_t *pts,
+    const uint8_t *const *messages,
+    const size_t *message_lens,
+    size_t n,
+    const ristretto255_hash_dst_t *dst
+) RISTRETTO_NONNULL RISTRETTO_NOINLINE;
+
+/**
+ * @brief Hash n messages to scalars, exactly as n calls to
+ * ristretto255_hash_to_scalar with the same DST.
+ *
+ * @param [out] out The n resulting scalars.
+ * @param [in] messages The n messages.
+ * @param [in] message_lens Their lengths in bytes.
+ * @param [in] n The number of messages.
+ * @param [in] dst The domain separation tag, from ristretto255_hash_dst_init.
+ */
+void ristretto255_hash_to_scalar_batch (
+    ristretto255_scalar_t *out,
+    const uint8_t *const *messages,
+    const size_t *message_lens,
+    size_t n,
+    const ristretto255_hash_dst_t *dst
+) RISTRETTO_NONNULL RISTRETTO_NOINLINE;
+
+/** Kinds of table that a table file can hold. */
+typedef enum {
+    RISTRETTO255_TABLE_COMB = 1, /**< ristretto255_precomputed_s */
+    RISTRETTO255_TABLE_WNAF = 2  /**< ristretto255_precomputed_wnaf_s */
+} ristretto255_table_kind_t;
+
+/** Size of a table file header. */
+#define RISTRETTO255_TABLE_FILE_HEADER_BYTES 128
+
+/**
+ * A table file mapped into memory.
+ *
+ * The file is a 128-byte header followed by count tables.  All header
+ * fields are little-endian: the magic "R255TBL\0", a version, the table
+ * kind, a tag describing the field element layout, the size of one table,
+ * the count, the payload offset, a tag describing the comb and wNAF table
+ * shapes of the build, and a SHA-512 over the first 64 header bytes and
+ * the payload.  Files are only usable by builds with the same tags.  Each
+ * field element in the payload is stored as its little-endian limbs,
+ * zero-padded to its in-memory size, so that a little-endian host with the
+ * same limb layout uses it in place.
+ */
+typedef struct {
+    /** @cond internal */
+    const uint8_t *file;
+    size_t file_len;
+    size_t table_bytes;
+    /** @endcond */
+    ristretto255_table_kind_t kind; /**< The kind of the tables. */
+    size_t count;                   /**< The number of tables. */
+} ristretto255_table_file_t;
+
+/**
+ * @brief Size of a table file holding count tables of the given kind.
+ */
+size_t ristretto255_table_file_bytes (
+    ristretto255_table_kind_t kind,
+    size_t count
+) RISTRETTO_WARN_UNUSED;
+
+/**
+ * @brief Serialize comb tables into a table file image.
+ *
+ * @param [out] out A buffer of ristretto255_table_file_bytes(RISTRETTO255_TABLE_COMB, count) bytes.
+ * @param [in] tables A contiguous array of count tables, each
+ * ristretto255_sizeof_precomputed_s bytes.
+ * @param [in] count The number of tables.
+ */
+void ristretto255_table_file_encode_comb (
+    uint8_t *out,
+    const ristretto255_precomputed_s *tables,
+    size_t count
+) RISTRETTO_NONNULL RISTRETTO_NOINLINE;
+
+/**
+ * @brief Serialize wNAF tables into a table file image.
+ *
+ * @param [out] out A buffer of ristretto255_table_file_bytes(RISTRETTO255_TABLE_WNAF, count) bytes.
+ * @param [in] tables A contiguous array of count tables, each
+ * ristretto255_sizeof_precomputed_wnaf_s bytes.
+ * @param [in] count The number of tables.
+ */
+void ristretto255_table_file_encode_wnaf (
+    uint8_t *out,
+    const ristretto255_precomputed_wnaf_s *tables,
+    size_t count
+) RISTRETTO_NONNULL RISTRETTO_NOINLINE;
+
+/**
+ * @brief Check a table file image and view it in place.
+ *
+ * @param [out] view The view of the tables, which point into the image.
+ * @param [in] file The image, aligned to ristretto255_alignof_precomputed_s.
+ * @param [in] file_len The length of the image.
+ * @param [in] kind The kind of table expected.
+ * @param [in] verify If true, also check the SHA-512, which reads the
+ * whole payload.
+ *
+ * @retval RISTRETTO_SUCCESS The image is usable in place.
+ * @retval RISTRETTO_FAILURE The header is malformed, the digest does not
+ * match, or the image was written for a different limb layout or
+ * byte order.
+ */
+ristretto_error_t ristretto255_table_file_view (
+    ristretto255_table_file_t *view,
+    const uint8_t *file,
+    size_t file_len,
+    ristretto255_table_kind_t kind,
+    ristretto_bool_t verify
+) RISTRETTO_NONNULL RISTRETTO_WARN_UNUSED RISTRETTO_NOINLINE;
+
+/**
+ * @brief Map a table file read-only and view it in place.
+ *
+ * @param [out] map The mapping.  Release it with ristretto255_table_file_unmap.
+ * @param [in] path The file to map.
+ * @param [in] kind The kind of table expected.
+ * @param [in] verify If true, also check the SHA-512.
+ *
+ * @retval RISTRETTO_SUCCESS The file is mapped.
+ * @retval RISTRETTO_FAILURE The file could not be mapped or failed
+ * ristretto255_table_file_view.  Nothing is left mapped.
+ */
+ristretto_error_t ristretto255_table_file_map (
+    ristretto255_table_file_t *map,
+    const char *path,
+    ristretto255_table_kind_t kind,
+    ristretto_bool_t verify
+) RISTRETTO_NONNULL RISTRETTO_WARN_UNUSED RISTRETTO_NOINLINE;
+
+/** Unmap a table file from ristretto255_table_file_map. */
+void ristretto255_table_file_unmap (
+    ristretto255_table_file_t *map
+) RISTRETTO_NONNULL;
+
+/**
+ * @brief The i'th comb table in a table file, or NULL if the file holds
+ * another kind or i is out of range.
+ */
+const ristretto255_precomputed_s *ristretto255_table_file_comb (
+    const ristretto255_table_file_t *map,
+    size_t i
+) RISTRETTO_NONNULL RISTRETTO_WARN_UNUSED;
+
+/**
+ * @brief The i'th wNAF table in a table file, or NULL if the file holds
+ * another kind or i is out of range.
+ */
+const ristretto255_precomputed_wnaf_s *ristretto255_table_file_wnaf (
+    const ristretto255_table_file_t *map,
+    size_t i
+) RISTRETTO_NONNULL RISTRETTO_WARN_UNUSED;
+
+/**
+ * A bounded cache of decoded points and their wNAF tables, keyed by
+ * encoding.  It is split into shards with their own locks, and a key's
+ * hash picks one small set of slots in one shard, so lookups take constant
+ * time whatever the capacity.  Each set evicts with the CLOCK policy.  The
+ * cache may be shared between threads.
+ */
+typedef struct ristretto255_key_cache_s ristretto255_key_cache_t;
+
+/**
+ * @brief Create a key cache.
+ * @param [in] capacity The number of keys to hold, rounded up to a
+ * multiple of the shard count times the set size.
+ * @return The cache, or NULL if it could not be allocated.
+ */
+ristretto255_key_cache_t *ristretto255_key_cache_new (
+    size_t capacity
+) RISTRETTO_WARN_UNUSED;
+
+/** Destroy a key cache.  It must not be in use by any thread. */
+void ristretto255_key_cache_free (
+    ristretto255_key_cache_t *cache
+);
+
+/**
+ * @brief Count the lookups the cache has answered and missed.
+ * Failed decodings count as misses.
+ */
+void ristretto255_key_cache_stats (
+    ristretto255_key_cache_t *cache,
+    uint64_t *hits,
+    uint64_t *misses
+) RISTRETTO_NONNULL;
+
+/**
+ * @brief As ristretto255_point_decode, through the cache.
+ *
+ * Only valid, non-identity points are cached.
+ */
+ristretto_error_t ristretto255_key_cache_decode (
+    ristretto255_point_t *point,
+    ristretto255_key_cache_t *cache,
+    const uint8_t ser[RISTRETTO255_SER_BYTES],
+    ristretto_bool_t allow_identity
+) RISTRETTO_NONNULL RISTRETTO_WARN_UNUSED RISTRETTO_NOINLINE;
+
+/**
+ * @brief Decode base through the cache and multiply it by a public
+ * scalar, using its cached table.
+ *
+ * @retval RISTRETTO_SUCCESS The decoding succeeded.
+ * @retval RISTRETTO_FAILURE The decoding didn't succeed, and scaled is
+ * unspecified.
+ *
+ * @warning: This function takes variable time, and may leak the scalar
+ * used.
+ */
+ristretto_error_t ristretto255_key_cache_scalarmul_non_secret (
+    ristretto255_point_t *scaled,
+    ristretto255_key_cache_t *cache,
+    const uint8_t base[RISTRETTO255_SER_BYTES],
+    const ristretto255_scalar_t *scalar,
+    ristretto_bool_t allow_identity
+) RISTRETTO_NONNULL RISTRETTO_WARN_UNUSED RISTRETTO_NOINLINE;
+
+/**
+ * @brief Decode base2 through the cache and compute
+ * combo = scalar1*base + scalar2*base2, as in signature verification.
+ *
+ * @retval RISTRETTO_SUCCESS The decoding succeeded.
+ * @retval RISTRETTO_FAILURE The decoding didn't succeed, and combo is
+ * unspecified.
+ *
+ * @warning: This function takes variable time, and may leak the scalars
+ * used.
+ */
+ristretto_error_t ristretto255_key_cache_base_double_scalarmul_non_secret (
+    ristretto255_point_t *combo,
+    ristretto255_key_cache_t *cache,
+    const ristretto255_scalar_t *scalar1,
+    const uint8_t base2[RISTRETTO255_SER_BYTES],
+    const ristretto255_scalar_t *scalar2,
+    ristretto_bool_t allow_identity
+) RISTRETTO_NONNULL RISTRETTO_WARN_UNUSED RISTRETTO_NOINLINE;
+
+/**
+ * @brief As ristretto255_key_cache_scalarmul_non_secret, with the copied
+ * table in a workspace of
+ * ristretto255_workspace_size(RISTRETTO255_WS_KEY_CACHE, 1) bytes instead
+ * of on the stack.
+ */
+ristretto_error_t ristretto255_key_cache_scalarmul_non_secret_ws (
+    ristretto255_point_t *scaled,
+    ristretto255_key_cache_t *cache,
+    const uint8_t base[RISTRETTO255_SER_BYTES],
+    const ristretto255_scalar_t *scalar,
+    ristretto_bool_t allow_identity,
+    void *workspace
+) RISTRETTO_NONNULL RISTRETTO_WARN_UNUSED RISTRETTO_NOINLINE;
+
+/**
+ * @brief As ristretto255_key_cache_base_double_scalarmul_non_secret, with
+ * the copied table in a workspace of
+ * ristretto255_workspace_size(RISTRETTO255_WS_KEY_CACHE, 1) bytes instead
+ * of on the stack.
+ */
+ristretto_error_t ristretto255_key_cache_base_double_scalarmul_non_secret_ws (
+    ristretto255_point_t *combo,
+    ristretto255_key_cache_t *cache,
+    const ristretto255_scalar_t *scalar1,
+    const uint8_t base2[RISTRETTO255_SER_BYTES],
+    const ristretto255_scalar_t *scalar2,
+    ristretto_bool_t allow_identity,
+    void *workspace
+) RISTRETTO_NONNULL RISTRETTO_WARN_UNUSED RISTRETTO_NOINLINE;
+
+/**
+ * Counts of the primitive operations made by the calling thread, for
+ * profiling.  The library only counts when built with RISTRETTO_STATS
+ * defined (make STATS=1); otherwise every count stays zero.
+ */
+typedef struct {
+    uint64_t gf_mul;               /**< Field multiplications */
+    uint64_t gf_sqr;               /**< Field squarings */
+    uint64_t gf_mulw;              /**< Multiplications by a small constant */
+    uint64_t gf_isr;               /**< Inverse square roots, including batched ones */
+    uint64_t gf4_mul;              /**< Four-way vector multiplications */
+    uint64_t gf4_sqr;              /**< Four-way vector squarings */
+    uint64_t point_add;            /**< Point additions and subtractions */
+    uint64_t point_double;         /**< Point doublings */
+    uint64_t constant_time_lookup; /**< Constant-time table lookups */
+    uint64_t bzero;                /**< Calls to ristretto_bzero */
+} ristretto255_stats_t;
+
+/**
+ * @brief Copy the calling thread's operation counts.
+ * @retval RISTRETTO_TRUE The library was built with RISTRETTO_STATS.
+ * @retval RISTRETTO_FALSE It was not, and the counts are all zero.
+ */
+ristretto_bool_t ristretto255_stats_snapshot (
+    ristretto255_stats_t *stats
+) RISTRETTO_NONNULL;
+
+/** Zero the calling thread's operation counts. */
+void ristretto255_stats_reset (void);
+
 /** Securely erase a scalar. */
 void ristretto255_scalar_destroy (
     ristretto255_scalar_t *scalar
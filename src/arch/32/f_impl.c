@@ -10,6 +10,7 @@ void gf_mul (gf_25519_t *__restrict__ cs, const gf_25519_t *as, const gf_25519_t
 
     uint32_t bh[9];
     int i,j;
+    RISTRETTO_COUNT(gf_mul, 1);
     for (i=0; i<9; i++) bh[i] = b[i+1] * 19;
 
     uint32_t *c = cs->limb;
@@ -56,6 +57,7 @@ void gf_mulw_unsigned (gf_25519_t *__restrict__ cs, const gf_25519_t *as, uint32
     const uint32_t *a = as->limb, maske = ((1<<26)-1), masko = ((1<<25)-1);
     uint32_t *c = cs->limb;
     uint64_t accum = widemul(b, a[0]);
+    RISTRETTO_COUNT(gf_mulw, 1);
     c[0] = accum & maske;
     accum >>= 26;
 
@@ -85,6 +87,8 @@ void gf_mulw_unsigned (gf_25519_t *__restrict__ cs, const gf_25519_t *as, uint32
 }
 
 void gf_sqr (gf_25519_t *__restrict__ cs, const gf_25519_t *as) {
+    RISTRETTO_COUNT(gf_sqr, 1);
+    RISTRETTO_COUNT(gf_mul, -1); /* counted again by gf_mul */
     gf_mul(cs,as,as); /* Performs better with dedicated square */
 }
 
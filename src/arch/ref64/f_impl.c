@@ -10,6 +10,7 @@ void gf_mul (gf_25519_t *__restrict__ cs, const gf_25519_t *as, const gf_25519_t
 
     uint64_t bh[4];
     int i,j;
+    RISTRETTO_COUNT(gf_mul, 1);
     for (i=0; i<4; i++) bh[i] = b[i+1] * 19;
 
     uint64_t *c = cs->limb;
@@ -38,6 +39,7 @@ void gf_mul (gf_25519_t *__restrict__ cs, const gf_25519_t *as, const gf_25519_t
 void gf_mulw_unsigned (gf_25519_t *__restrict__ cs, const gf_25519_t *as, uint32_t b) {
     const uint64_t *a = as->limb, mask = ((1ull<<51)-1);
     int i;
+    RISTRETTO_COUNT(gf_mulw, 1);
 
     uint64_t *c = cs->limb;
 
@@ -58,5 +60,7 @@ void gf_mulw_unsigned (gf_25519_t *__restrict__ cs, const gf_25519_t *as, uint32
 }
 
 void gf_sqr (gf_25519_t *__restrict__ cs, const gf_25519_t *as) {
+    RISTRETTO_COUNT(gf_sqr, 1);
+    RISTRETTO_COUNT(gf_mul, -1); /* counted again by gf_mul */
     gf_mul(cs,as,as); /* Performs better with dedicated square */
 }
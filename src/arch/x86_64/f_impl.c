@@ -11,6 +11,7 @@ void gf_mul (gf_25519_t *__restrict__ cs, const gf_25519_t *as, const gf_25519_t
     uint64_t *c = cs->limb;
 
     __uint128_t accum0, accum1, accum2;
+    RISTRETTO_COUNT(gf_mul, 1);
 
     uint64_t ai = a[0];
     accum0 = widemul_rm(ai, &b[0]);
@@ -87,6 +88,7 @@ void gf_sqr (gf_25519_t *__restrict__ cs, const gf_25519_t *as) {
     uint64_t *c = cs->limb;
 
     __uint128_t accum0, accum1, accum2;
+    RISTRETTO_COUNT(gf_sqr, 1);
 
     uint64_t ai = a[0];
     accum0 = widemul_rr(ai, ai);
@@ -145,6 +147,7 @@ void gf_mulw_unsigned (gf_25519_t *__restrict__ cs, const gf_25519_t *as, uint32
     const uint64_t *a = as->limb, mask = ((1ull<<51)-1);
     uint64_t *c = cs->limb;
 
+    RISTRETTO_COUNT(gf_mulw, 1);
     __uint128_t accum = widemul_rm(b, &a[0]);
     uint64_t c0 = accum & mask;
     accum = shrld(accum,51);
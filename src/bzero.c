@@ -9,11 +9,13 @@
  */
 
 #include <ristretto255.h>
+#include "stats.h"
 
 void ristretto_bzero (
     void *s,
     size_t size
 ) {
+    RISTRETTO_COUNT(bzero, 1);
 #ifdef __STDC_LIB_EXT1__
     memset_s(s, size, 0, size);
 #else
@@ -12,6 +12,7 @@
 #define __CONSTANT_TIME_H__ 1
 
 #include "word.h"
+#include "stats.h"
 #include <string.h>
 
 /*
@@ -49,6 +50,13 @@ typedef struct {
     word_t unaligned;
 } __attribute__((packed)) unaligned_word_t;
 
+/**
+ * Unaligned lookup register.
+ */
+typedef struct {
+    lookup_register_t unaligned;
+} __attribute__((packed)) unaligned_lr_t;
+
 /**
  * @brief Constant-time conditional swap.
  *
@@ -146,6 +154,7 @@ constant_time_lookup (
     const unsigned char *table = (const unsigned char *)table_;
     word_t j,k;
 
+    RISTRETTO_COUNT(constant_time_lookup, 1);
     memset(out, 0, elem_bytes);
     for (j=0; j<n_table; j++, big_i-=big_one) {
         big_register_t br_mask = br_is_zero(big_i);
@@ -181,6 +190,80 @@ constant_time_lookup (
     }
 }
 
+/**
+ * @brief As constant_time_lookup, for tables laid out for it: entries are
+ * a whole number of big_register_t.  If they are also a whole number of
+ * lookup_register_t, the table and output must be LOOKUP_ALIGNED, and
+ * otherwise VECTOR_ALIGNED.
+ *
+ * Every entry is selected with a full-width compare, and the result is
+ * gathered in registers and stored once, so there is no read-modify-write
+ * of the output per entry.  Entries that are not whole lookup registers
+ * are read unaligned, and finished with a big register.
+ */
+static __inline__ void
+__attribute__((unused,always_inline))
+constant_time_lookup_aligned (
+    void *__restrict__ out_,
+    const void *table_,
+    word_t elem_bytes,
+    word_t n_table,
+    word_t idx
+) {
+    const word_t nregs = elem_bytes / sizeof(lookup_register_t);
+    const lookup_register_t lr_one = lr_set_to_mask(1), lr_idx = lr_set_to_mask(idx);
+    word_t j,k;
+
+    assert(elem_bytes % sizeof(big_register_t) == 0);
+
+    RISTRETTO_COUNT(constant_time_lookup, 1);
+    if (elem_bytes % sizeof(lookup_register_t) == 0) {
+        lookup_register_t *out = (lookup_register_t *)out_;
+        const lookup_register_t *table = (const lookup_register_t *)table_;
+
+        /* Two registers of the output at a time, so that the accumulators
+         * stay in registers even where the loops aren't unrolled */
+        for (k=0; k+1<nregs; k+=2) {
+            lookup_register_t acc0 = lr_set_to_mask(0), acc1 = acc0, lr_i = lr_idx;
+            for (j=0; j<n_table; j++, lr_i-=lr_one) {
+                lookup_register_t lr_mask = lr_is_zero(lr_i);
+                acc0 |= lr_mask & table[j*nregs+k];
+                acc1 |= lr_mask & table[j*nregs+k+1];
+            }
+            out[k] = acc0;
+            out[k+1] = acc1;
+        }
+        if (k<nregs) {
+            lookup_register_t acc = lr_set_to_mask(0), lr_i = lr_idx;
+            for (j=0; j<n_table; j++, lr_i-=lr_one) {
+                acc |= lr_is_zero(lr_i) & table[j*nregs+k];
+            }
+            out[k] = acc;
+        }
+    } else {
+        unsigned char *out = (unsigned char *)out_;
+        const unsigned char *table = (const unsigned char *)table_;
+        const big_register_t br_one = br_set_to_mask(1), br_idx = br_set_to_mask(idx);
+
+        /* Whole lookup registers unaligned, and then big registers */
+        for (k=0; k<nregs; k++) {
+            lookup_register_t acc = lr_set_to_mask(0), lr_i = lr_idx;
+            for (j=0; j<n_table; j++, lr_i-=lr_one) {
+                acc |= lr_is_zero(lr_i)
+                    & ((const unaligned_lr_t *)&table[j*elem_bytes + k*sizeof(lookup_register_t)])->unaligned;
+            }
+            ((unaligned_lr_t *)&out[k*sizeof(lookup_register_t)])->unaligned = acc;
+        }
+        for (k*=sizeof(lookup_register_t); k<elem_bytes; k+=sizeof(big_register_t)) {
+            big_register_t acc = br_set_to_mask(0), br_i = br_idx;
+            for (j=0; j<n_table; j++, br_i-=br_one) {
+                acc |= br_is_zero(br_i) & *(const big_register_t *)&table[j*elem_bytes + k];
+            }
+            *(big_register_t *)&out[k] = acc;
+        }
+    }
+}
+
 /**
  * @brief Constant-time equivalent of memcpy(table + elem_bytes*idx, in, elem_bytes);
  *
@@ -10,8 +10,10 @@
  */
 
 #include <ristretto255.h>
+#include <string.h>
 #include "word.h"
 #include "field.h"
+#include "f_vector.h"
 
 #define point_t ristretto255_point_t
 
@@ -30,44 +32,80 @@ extern mask_t ristretto255_deisogenize (
     mask_t toggle_rotation
 );
 
-void ristretto255_point_from_hash_nonuniform (
-    point_t *p,
+extern void ristretto255_deisogenize_isr_input (
+    gf_25519_t *x,
+    gf_25519_t *num,
+    gf_25519_t *den,
+    const point_t *p
+);
+
+extern void ristretto255_deisogenize_finish (
+    gf_25519_t *__restrict__ s,
+    gf_25519_t *__restrict__ inv_el_sum,
+    gf_25519_t *__restrict__ inv_el_m1,
+    const point_t *p,
+    const gf_25519_t *num,
+    const gf_25519_t *den,
+    const gf_25519_t *isr,
+    mask_t toggle_s,
+    mask_t toggle_altx,
+    mask_t toggle_rotation
+);
+
+/* The state of one Elligator evaluation across its inverse square root */
+typedef struct {
+    gf_25519_t r0, r, N;
+} elligator_state_t;
+
+/* Everything before the isr.  Returns the value whose isr we need. */
+static void elligator_prepare (
+    elligator_state_t *st,
+    gf_25519_t *isr_input,
     const unsigned char ser[SER_BYTES]
 ) {
-    gf_25519_t r0,r,a,b,c,N,e;
+    gf_25519_t a,b,c;
     const uint8_t mask = (uint8_t)(0xFE<<(6));
-    ignore_result(gf_deserialize(&r0,ser,0,mask));
-    gf_strong_reduce(&r0);
-    gf_sqr(&a,&r0);
-    gf_mul_qnr(&r,&a);
+    ignore_result(gf_deserialize(&st->r0,ser,0,mask));
+    gf_strong_reduce(&st->r0);
+    gf_sqr(&a,&st->r0);
+    gf_mul_qnr(&st->r,&a);
 
     /* Compute D@c := (dr+a-d)(dr-ar-d) with a=1 */
-    gf_sub(&a,&r,&ONE);
+    gf_sub(&a,&st->r,&ONE);
     gf_mulw(&b,&a,EDWARDS_D); /* dr-d */
     gf_add(&a,&b,&ONE);
-    gf_sub(&b,&b,&r);
+    gf_sub(&b,&b,&st->r);
     gf_mul(&c,&a,&b);
 
     /* compute N := (r+1)(a-2d) */
-    gf_add(&a,&r,&ONE);
-    gf_mulw(&N,&a,1-2*EDWARDS_D);
+    gf_add(&a,&st->r,&ONE);
+    gf_mulw(&st->N,&a,1-2*EDWARDS_D);
 
     /* e = +-sqrt(1/ND) or +-r0 * sqrt(qnr/ND) */
-    gf_mul(&a,&c,&N);
-    mask_t square = gf_isr(&b,&a);
-    gf_cond_sel(&c,&r0,&ONE,square); /* r? = square ? 1 : r0 */
-    gf_mul(&e,&b,&c);
+    gf_mul(isr_input,&c,&st->N);
+}
+
+/* Everything after the isr */
+static void elligator_finish (
+    point_t *p,
+    const elligator_state_t *st,
+    const gf_25519_t *isr_output,
+    mask_t square
+) {
+    gf_25519_t a,b,c,e;
+    gf_cond_sel(&c,&st->r0,&ONE,square); /* r? = square ? 1 : r0 */
+    gf_mul(&e,isr_output,&c);
 
     /* s@a = +-|N.e| */
-    gf_mul(&a,&N,&e);
+    gf_mul(&a,&st->N,&e);
     gf_cond_neg(&a,gf_lobit(&a) ^ ~square);
 
     /* t@b = -+ cN(r-1)((a-2d)e)^2 - 1 */
     gf_mulw(&c,&e,1-2*EDWARDS_D); /* (a-2d)e */
     gf_sqr(&b,&c);
-    gf_sub(&e,&r,&ONE);
+    gf_sub(&e,&st->r,&ONE);
     gf_mul(&c,&b,&e);
-    gf_mul(&b,&c,&N);
+    gf_mul(&b,&c,&st->N);
     gf_cond_neg(&b,square);
     gf_sub(&b,&b,&ONE);
 
@@ -87,6 +125,17 @@ void ristretto255_point_from_hash_nonuniform (
     assert(ristretto255_point_valid(p));
 }
 
+void ristretto255_point_from_hash_nonuniform (
+    point_t *p,
+    const unsigned char ser[SER_BYTES]
+) {
+    elligator_state_t st;
+    gf_25519_t a,b;
+    elligator_prepare(&st,&a,ser);
+    mask_t square = gf_isr(&b,&a);
+    elligator_finish(p,&st,&b,square);
+}
+
 void ristretto255_point_from_hash_uniform (
     point_t *pt,
     const unsigned char hashed_data[2*SER_BYTES]
@@ -97,6 +146,35 @@ void ristretto255_point_from_hash_uniform (
     ristretto255_point_add(pt,pt,&pt2);
 }
 
+/* Points per pass of the batch hash; two Elligator evaluations each */
+#define HASH_BATCH 4
+
+void ristretto255_point_from_hash_uniform_batch (
+    point_t *pts,
+    const unsigned char *hashed_data,
+    size_t n
+) {
+    elligator_state_t st[2*HASH_BATCH];
+    gf_25519_t isr[2*HASH_BATCH];
+    mask_t square[2*HASH_BATCH];
+    point_t pt2;
+    size_t i;
+    unsigned int j, m;
+
+    for (i=0; i<n; i+=m) {
+        m = (n-i < HASH_BATCH) ? n-i : HASH_BATCH;
+        for (j=0; j<2*m; j++) {
+            elligator_prepare(&st[j],&isr[j],&hashed_data[(2*i+j)*SER_BYTES]);
+        }
+        gf_isr_batch(isr,square,isr,2*m);
+        for (j=0; j<m; j++) {
+            elligator_finish(&pts[i+j],&st[2*j],&isr[2*j],square[2*j]);
+            elligator_finish(&pt2,&st[2*j+1],&isr[2*j+1],square[2*j+1]);
+            ristretto255_point_add(&pts[i+j],&pts[i+j],&pt2);
+        }
+    }
+}
+
 /* Elligator_onto:
  * Make elligator-inverse onto at the cost of roughly halving the success probability.
  * Currently no effect for curves with field size 1 bit mod 8 (where the top bit
@@ -105,22 +183,35 @@ void ristretto255_point_from_hash_uniform (
  */
 #define MAX(A,B) (((A)>(B)) ? (A) : (B))
 
-ristretto_error_t
-ristretto255_invert_elligator_nonuniform (
-    unsigned char recovered_hash[SER_BYTES],
+/* The state of one Elligator inversion across its inverse square root */
+typedef struct {
+    gf_25519_t a;
+    mask_t zero;
+} elligator_inv_state_t;
+
+/*
+ * Everything before the isr, given num, den and the isr from deisogenize.
+ * Only bits 0, 1 and 3 of the hint matter here; bits 2 and 4 are applied by
+ * the finish.
+ */
+static void invert_elligator_prepare (
+    elligator_inv_state_t *st,
+    gf_25519_t *isr_input,
     const point_t *p,
+    const gf_25519_t *deiso_num,
+    const gf_25519_t *deiso_den,
+    const gf_25519_t *deiso_isr,
     uint32_t hint_
 ) {
     mask_t hint = hint_;
     mask_t sgn_s = -(hint & 1),
         sgn_altx = -(hint>>1 & 1),
-        sgn_r0 = -(hint>>2 & 1),
         /* FUTURE MAGIC: eventually if there's a curve which needs sgn_ed_T but not sgn_r0,
          * change this mask extraction.
          */
         sgn_ed_T = -(hint>>3 & 1);
     gf_25519_t a,b,c;
-    ristretto255_deisogenize(&a,&b,&c,p,sgn_s,sgn_altx,sgn_ed_T);
+    ristretto255_deisogenize_finish(&a,&b,&c,p,deiso_num,deiso_den,deiso_isr,sgn_s,sgn_altx,sgn_ed_T);
 
     mask_t is_identity = gf_eq(&p->t,&ZERO);
 
@@ -141,10 +232,25 @@ ristretto255_invert_elligator_nonuniform (
     gf_add(&b,&b,&c);
     gf_cond_swap(&a,&b,sgn_s);
     gf_mul_qnr(&c,&b);
-    gf_mul(&b,&c,&a);
-    mask_t succ = gf_isr(&c,&b);
-    succ |= gf_eq(&b,&ZERO);
-    gf_mul(&b,&c,&a);
+    gf_mul(isr_input,&c,&a);
+    gf_copy(&st->a,&a);
+    st->zero = gf_eq(isr_input,&ZERO);
+}
+
+/* Everything after the isr.  Returns the success mask. */
+static mask_t invert_elligator_finish (
+    unsigned char recovered_hash[SER_BYTES],
+    const elligator_inv_state_t *st,
+    const gf_25519_t *isr_output,
+    mask_t square,
+    uint32_t hint_
+) {
+    mask_t hint = hint_;
+    mask_t sgn_s = -(hint & 1),
+        sgn_r0 = -(hint>>2 & 1);
+    gf_25519_t b;
+    mask_t succ = square | st->zero;
+    gf_mul(&b,isr_output,&st->a);
 
     gf_cond_neg(&b, sgn_r0^gf_lobit(&b));
     /* Eliminate duplicate values for identity ... */
@@ -153,10 +259,59 @@ ristretto255_invert_elligator_nonuniform (
 
     gf_serialize(recovered_hash,&b,1);
     recovered_hash[SER_BYTES-1] ^= (hint>>4)<<7;
+    return succ;
+}
 
+ristretto_error_t
+ristretto255_invert_elligator_nonuniform (
+    unsigned char recovered_hash[SER_BYTES],
+    const point_t *p,
+    uint32_t hint
+) {
+    elligator_inv_state_t st;
+    gf_25519_t a,b,num,den;
+    ristretto255_deisogenize_isr_input(&b,&num,&den,p);
+    gf_isr(&a,&b);
+    invert_elligator_prepare(&st,&b,p,&num,&den,&a,hint);
+    mask_t square = gf_isr(&a,&b);
+    mask_t succ = invert_elligator_finish(recovered_hash,&st,&a,square,hint);
     return ristretto_succeed_if(mask_to_bool(succ));
 }
 
+/* The hint bits which change the isr: sgn_s, sgn_altx and sgn_ed_T */
+#define INVERT_ISR_COUNT 8
+#define INVERT_ISR_INDEX(which) (((which) & 3) | ((which)>>1 & 4))
+#define HIBIT (1u<<(RISTRETTO255_INVERT_ELLIGATOR_WHICH_BITS-1))
+
+uint32_t ristretto255_invert_elligator_nonuniform_all (
+    unsigned char recovered_hashes[1<<RISTRETTO255_INVERT_ELLIGATOR_WHICH_BITS][SER_BYTES],
+    const point_t *p
+) {
+    elligator_inv_state_t st[INVERT_ISR_COUNT];
+    gf_25519_t isr[INVERT_ISR_COUNT], deiso_isr, deiso_num, deiso_den;
+    mask_t square[INVERT_ISR_COUNT];
+    uint32_t which, ret = 0;
+    unsigned int k;
+
+    ristretto255_deisogenize_isr_input(&deiso_isr,&deiso_num,&deiso_den,p);
+    gf_isr(&deiso_isr,&deiso_isr);
+    for (k=0; k<INVERT_ISR_COUNT; k++) {
+        /* Spread k back out over hint bits 0, 1 and 3 */
+        invert_elligator_prepare(&st[k],&isr[k],p,&deiso_num,&deiso_den,&deiso_isr,(k & 3) | (k & 4)<<1);
+    }
+    gf_isr_batch(isr,square,isr,INVERT_ISR_COUNT);
+
+    /* The top bit of "which" only sets the unused high bit of the encoding */
+    for (which=0; which < HIBIT; which++) {
+        k = INVERT_ISR_INDEX(which);
+        mask_t succ = invert_elligator_finish(recovered_hashes[which],&st[k],&isr[k],square[k],which);
+        memcpy(recovered_hashes[which|HIBIT],recovered_hashes[which],SER_BYTES);
+        recovered_hashes[which|HIBIT][SER_BYTES-1] ^= 0x80;
+        ret |= (uint32_t)(succ & 1) * (1u<<which | 1u<<(which|HIBIT));
+    }
+    return ret;
+}
+
 ristretto_error_t
 ristretto255_invert_elligator_uniform (
     unsigned char partial_hash[2*SER_BYTES],
@@ -168,3 +323,73 @@ ristretto255_invert_elligator_uniform (
     ristretto255_point_sub(&pt2,p,&pt2);
     return ristretto255_invert_elligator_nonuniform(partial_hash,&pt2,hint);
 }
+
+uint32_t ristretto255_invert_elligator_uniform_all (
+    unsigned char recovered_hashes[1<<RISTRETTO255_INVERT_ELLIGATOR_WHICH_BITS][2*SER_BYTES],
+    const point_t *p,
+    const unsigned char partial_hash[SER_BYTES]
+) {
+    unsigned char hashes[1<<RISTRETTO255_INVERT_ELLIGATOR_WHICH_BITS][SER_BYTES];
+    point_t pt2;
+    uint32_t which, ret;
+    ristretto255_point_from_hash_nonuniform(&pt2,partial_hash);
+    ristretto255_point_sub(&pt2,p,&pt2);
+    ret = ristretto255_invert_elligator_nonuniform_all(hashes,&pt2);
+    for (which=0; which < 1u<<RISTRETTO255_INVERT_ELLIGATOR_WHICH_BITS; which++) {
+        memcpy(recovered_hashes[which],hashes[which],SER_BYTES);
+        memcpy(&recovered_hashes[which][SER_BYTES],partial_hash,SER_BYTES);
+    }
+    return ret;
+}
+
+/* Points per pass of the batch inverse: one block of gf_isr_batch */
+#define INVERT_BATCH 8
+
+ristretto_error_t ristretto255_invert_elligator_uniform_batch (
+    unsigned char *recovered_hashes,
+    ristretto_bool_t *success,
+    const point_t *pts,
+    const unsigned char *hints,
+    size_t n
+) {
+    elligator_state_t est[INVERT_BATCH];
+    elligator_inv_state_t ist[INVERT_BATCH];
+    gf_25519_t isr[INVERT_BATCH], isr_input[INVERT_BATCH], num[INVERT_BATCH], den[INVERT_BATCH];
+    mask_t square[INVERT_BATCH], all = -(mask_t)1;
+    point_t diff[INVERT_BATCH];
+    size_t i;
+    unsigned int j, m;
+
+    for (i=0; i<n; i+=m) {
+        unsigned char *hash = &recovered_hashes[2*SER_BYTES*i];
+        m = (n-i < INVERT_BATCH) ? n-i : INVERT_BATCH;
+
+        /* Map the given second halves forward, and subtract them off */
+        for (j=0; j<m; j++) {
+            elligator_prepare(&est[j],&isr_input[j],&hash[2*SER_BYTES*j+SER_BYTES]);
+        }
+        gf_isr_batch(isr,square,isr_input,m);
+        for (j=0; j<m; j++) {
+            elligator_finish(&diff[j],&est[j],&isr[j],square[j]);
+            ristretto255_point_sub(&diff[j],&pts[i+j],&diff[j]);
+        }
+
+        /* Deisogenize the differences */
+        for (j=0; j<m; j++) ristretto255_deisogenize_isr_input(&isr_input[j],&num[j],&den[j],&diff[j]);
+        gf_isr_batch(isr,square,isr_input,m);
+
+        /* Invert the first halves */
+        for (j=0; j<m; j++) {
+            invert_elligator_prepare(&ist[j],&isr_input[j],&diff[j],&num[j],&den[j],&isr[j],hints[i+j]);
+        }
+        gf_isr_batch(isr,square,isr_input,m);
+        for (j=0; j<m; j++) {
+            mask_t succ = invert_elligator_finish(&hash[2*SER_BYTES*j],&ist[j],&isr[j],square[j],hints[i+j]);
+            success[i+j] = mask_to_bool(succ);
+            all &= succ;
+        }
+    }
+
+    ristretto_bzero(diff,sizeof(diff));
+    return ristretto_succeed_if(mask_to_bool(all));
+}
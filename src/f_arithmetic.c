@@ -24,6 +24,7 @@ const gf_25519_t SQRT_MINUS_ONE = FIELD_LITERAL(
 mask_t gf_isr (gf_25519_t *a, const gf_25519_t *x) {
     gf_25519_t L0, L1, L2, L3;
 
+    RISTRETTO_COUNT(gf_isr, 1);
     gf_sqr (&L0, x);
     gf_mul (&L1, &L0, x);
     gf_sqr (&L0, &L1);
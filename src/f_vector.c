@@ -0,0 +1,348 @@
+/**
+ * @cond internal
+ * @file f_vector.c
+ * @copyright
+ *   Copyright (c) 2015-2018 Ristretto Developers, Cryptography Research, Inc.  \n
+ *   Released under the MIT License.  See LICENSE.txt for license information.
+ * @author Mike Hamburg
+ * @brief Four-way vectorized field arithmetic.
+ */
+
+#include <ristretto255.h>
+#include "f_vector.h"
+
+#if __AVX2__
+
+#define GF4_EVEN_MASK ((1ull<<26)-1)
+#define GF4_ODD_MASK  ((1ull<<25)-1)
+
+static RISTRETTO_INLINE uint64x4_t gf4_set1(uint64_t x) {
+    uint64x4_t ret = {x,x,x,x};
+    return ret;
+}
+
+/** Low 32 bits of each lane times low 32 bits of each lane */
+static RISTRETTO_INLINE uint64x4_t gf4_mul32(uint64x4_t a, uint64x4_t b) {
+    return (uint64x4_t)_mm256_mul_epu32((__m256i)a, (__m256i)b);
+}
+
+static RISTRETTO_INLINE uint64x4_t gf4_times19(uint64x4_t a) {
+    return (a<<4) + (a<<1) + a;
+}
+
+/** Carry a product so that each limb is within a few bits of its place value. */
+static RISTRETTO_INLINE void gf4_carry(uint64x4_t h[GF4_LIMBS]) {
+    const uint64x4_t even = gf4_set1(GF4_EVEN_MASK), odd = gf4_set1(GF4_ODD_MASK);
+
+    /* Two interleaved chains, to shorten the dependency path */
+    h[1] += h[0]>>26; h[0] &= even;
+    h[5] += h[4]>>26; h[4] &= even;
+    h[2] += h[1]>>25; h[1] &= odd;
+    h[6] += h[5]>>25; h[5] &= odd;
+    h[3] += h[2]>>26; h[2] &= even;
+    h[7] += h[6]>>26; h[6] &= even;
+    h[4] += h[3]>>25; h[3] &= odd;
+    h[8] += h[7]>>25; h[7] &= odd;
+    h[5] += h[4]>>26; h[4] &= even;
+    h[9] += h[8]>>26; h[8] &= even;
+    h[0] += gf4_times19(h[9]>>25); h[9] &= odd;
+    h[1] += h[0]>>26; h[0] &= even;
+}
+
+void gf4_load (gf4_25519_t *out, const gf_25519_t in[4]) {
+    gf_25519_t red[4];
+    unsigned int i, j;
+    for (j=0; j<4; j++) {
+        gf_copy(&red[j], &in[j]);
+        gf_weak_reduce(&red[j]);
+    }
+    for (i=0; i<GF4_LIMBS; i++) {
+#if LIMB_PLACE_VALUE(0) == 51
+        /* Split each 51-bit limb into 26 and 25 bits */
+        unsigned int shift = (i&1) ? 26 : 0;
+        uint64_t mask = (i&1) ? ~0ull : GF4_EVEN_MASK;
+        uint64x4_t v = {
+            (red[0].limb[LIMBPERM(i/2)] >> shift) & mask,
+            (red[1].limb[LIMBPERM(i/2)] >> shift) & mask,
+            (red[2].limb[LIMBPERM(i/2)] >> shift) & mask,
+            (red[3].limb[LIMBPERM(i/2)] >> shift) & mask
+        };
+#else
+        uint64x4_t v = {
+            red[0].limb[LIMBPERM(i)],
+            red[1].limb[LIMBPERM(i)],
+            red[2].limb[LIMBPERM(i)],
+            red[3].limb[LIMBPERM(i)]
+        };
+#endif
+        out->limb[i] = v;
+    }
+}
+
+void gf4_store (gf_25519_t out[4], const gf4_25519_t *in) {
+    uint64x4_t h[GF4_LIMBS];
+    unsigned int i, j;
+    for (i=0; i<GF4_LIMBS; i++) h[i] = in->limb[i];
+    gf4_carry(h);
+
+    for (j=0; j<4; j++) {
+#if LIMB_PLACE_VALUE(0) == 51
+        /* Place values line up, so any carries land in the right place */
+        for (i=0; i<5; i++) {
+            out[j].limb[LIMBPERM(i)] = h[2*i][j] + (h[2*i+1][j]<<26);
+        }
+#else
+        for (i=0; i<GF4_LIMBS; i++) out[j].limb[LIMBPERM(i)] = h[i][j];
+#endif
+    }
+}
+
+/**
+ * Schoolbook product.  Limbs i and j of a radix-2^25.5 product need an
+ * extra factor of 2 when both are odd, and wrapping past limb 9 costs a
+ * factor of 19.
+ */
+void gf4_mul (gf4_25519_t *__restrict__ out, const gf4_25519_t *a, const gf4_25519_t *b) {
+    const uint64x4_t *f = a->limb, *g = b->limb;
+    uint64x4_t g19[GF4_LIMBS], h[GF4_LIMBS];
+    unsigned int i, j;
+
+    RISTRETTO_COUNT(gf4_mul, 1);
+
+    for (i=0; i<GF4_LIMBS; i++) {
+        g19[i] = gf4_mul32(g[i], gf4_set1(19));
+        h[i] = gf4_set1(0);
+    }
+
+    UNROLL for (i=0; i<GF4_LIMBS; i++) {
+        uint64x4_t fi = f[i], fi2 = (i&1) ? f[i]+f[i] : f[i];
+        UNROLL for (j=0; j<GF4_LIMBS-i; j++) {
+            h[i+j] += gf4_mul32((j&1) ? fi2 : fi, g[j]);
+        }
+        UNROLL for (; j<GF4_LIMBS; j++) {
+            h[i+j-GF4_LIMBS] += gf4_mul32((j&1) ? fi2 : fi, g19[j]);
+        }
+    }
+
+    gf4_carry(h);
+    for (i=0; i<GF4_LIMBS; i++) out->limb[i] = h[i];
+}
+
+void gf4_sqr (gf4_25519_t *__restrict__ out, const gf4_25519_t *a) {
+    const uint64x4_t *f = a->limb;
+    uint64x4_t f19[GF4_LIMBS], h[GF4_LIMBS];
+    unsigned int i, j;
+
+    RISTRETTO_COUNT(gf4_sqr, 1);
+
+    for (i=0; i<GF4_LIMBS; i++) {
+        f19[i] = gf4_mul32(f[i], gf4_set1(19));
+        h[i] = gf4_set1(0);
+    }
+
+    UNROLL for (i=0; i<GF4_LIMBS; i++) {
+        /* Cross terms appear twice; keep the 2 and 4 on this side so that
+         * the other side can carry the 19 without overflowing 32 bits.
+         */
+        uint64x4_t fi = f[i], fi2 = f[i]+f[i], fi4 = fi2+fi2;
+        h[(2*i)%GF4_LIMBS] += gf4_mul32((i&1) ? fi2 : fi, (2*i >= GF4_LIMBS) ? f19[i] : f[i]);
+        UNROLL for (j=i+1; j<GF4_LIMBS; j++) {
+            h[(i+j)%GF4_LIMBS] += gf4_mul32((i&j&1) ? fi4 : fi2, (i+j >= GF4_LIMBS) ? f19[j] : f[j]);
+        }
+    }
+
+    gf4_carry(h);
+    for (i=0; i<GF4_LIMBS; i++) out->limb[i] = h[i];
+}
+
+void gf4_sqrn (gf4_25519_t *__restrict__ y, const gf4_25519_t *x, int n) {
+    gf4_25519_t tmp;
+    assert(n>0);
+    if (n&1) {
+        gf4_sqr(y,x);
+        n--;
+    } else {
+        gf4_sqr(&tmp,x);
+        gf4_sqr(y,&tmp);
+        n-=2;
+    }
+    for (; n; n-=2) {
+        gf4_sqr(&tmp,y);
+        gf4_sqr(y,&tmp);
+    }
+}
+
+void gf4_add (gf4_25519_t *out, const gf4_25519_t *a, const gf4_25519_t *b) {
+    uint64x4_t h[GF4_LIMBS];
+    unsigned int i;
+    for (i=0; i<GF4_LIMBS; i++) h[i] = a->limb[i] + b->limb[i];
+    gf4_carry(h);
+    for (i=0; i<GF4_LIMBS; i++) out->limb[i] = h[i];
+}
+
+/** Biased by 2p, which is larger limbwise than any carried input. */
+void gf4_sub (gf4_25519_t *out, const gf4_25519_t *a, const gf4_25519_t *b) {
+    uint64x4_t h[GF4_LIMBS];
+    unsigned int i;
+    for (i=0; i<GF4_LIMBS; i++) {
+        uint64_t bias = (i==0) ? 2*(GF4_EVEN_MASK-18) : (i&1) ? 2*GF4_ODD_MASK : 2*GF4_EVEN_MASK;
+        h[i] = a->limb[i] + gf4_set1(bias) - b->limb[i];
+    }
+    gf4_carry(h);
+    for (i=0; i<GF4_LIMBS; i++) out->limb[i] = h[i];
+}
+
+void gf4_mulw (gf4_25519_t *out, const gf4_25519_t *a, uint32_t w) {
+    uint64x4_t h[GF4_LIMBS];
+    unsigned int i;
+    for (i=0; i<GF4_LIMBS; i++) h[i] = gf4_mul32(a->limb[i], gf4_set1(w));
+    gf4_carry(h);
+    for (i=0; i<GF4_LIMBS; i++) out->limb[i] = h[i];
+}
+
+void gf4_load_lanes (gf4_25519_t *out, const ristretto_word_t in[RISTRETTO255_FIELD_LIMBS][4]) {
+    unsigned int i;
+    for (i=0; i<GF4_LIMBS; i++) {
+#if LIMB_PLACE_VALUE(0) == 51
+        /* One load per pair of limbs, split as in gf4_load */
+        uint64x4_t v;
+        memcpy(&v, in[LIMBPERM(i/2)], sizeof(v));
+        out->limb[i] = (i&1) ? v>>26 : v & gf4_set1(GF4_EVEN_MASK);
+#else
+        const ristretto_word_t *w = in[LIMBPERM(i)];
+        uint64x4_t v = { w[0], w[1], w[2], w[3] };
+        out->limb[i] = v;
+#endif
+    }
+}
+
+void gf4_store_lanes (ristretto_word_t out[RISTRETTO255_FIELD_LIMBS][4], const gf4_25519_t *in) {
+    uint64x4_t h[GF4_LIMBS];
+    unsigned int i;
+    for (i=0; i<GF4_LIMBS; i++) h[i] = in->limb[i];
+    gf4_carry(h);
+
+#if LIMB_PLACE_VALUE(0) == 51
+    for (i=0; i<5; i++) {
+        uint64x4_t v = h[2*i] + (h[2*i+1]<<26);
+        memcpy(out[LIMBPERM(i)], &v, sizeof(v));
+    }
+#else
+    for (i=0; i<GF4_LIMBS; i++) {
+        unsigned int j;
+        for (j=0; j<4; j++) out[LIMBPERM(i)][j] = h[i][j];
+    }
+#endif
+}
+
+/* Two vectors in flight at once, because one chain of squarings is
+ * latency-bound and leaves most of the vector unit idle.
+ */
+#define GF4_BLOCK 2
+#define GF4_BLOCK_LANES (4*GF4_BLOCK)
+
+static void gf4_mul_block (
+    gf4_25519_t out[GF4_BLOCK],
+    const gf4_25519_t a[GF4_BLOCK],
+    const gf4_25519_t b[GF4_BLOCK]
+) {
+    unsigned int k;
+    for (k=0; k<GF4_BLOCK; k++) gf4_mul(&out[k], &a[k], &b[k]);
+}
+
+static void gf4_sqrn_block (
+    gf4_25519_t y[GF4_BLOCK],
+    const gf4_25519_t x[GF4_BLOCK],
+    int n
+) {
+    gf4_25519_t tmp[GF4_BLOCK];
+    unsigned int k;
+    assert(n>0);
+    if (n&1) {
+        for (k=0; k<GF4_BLOCK; k++) gf4_sqr(&y[k], &x[k]);
+        n--;
+    } else {
+        for (k=0; k<GF4_BLOCK; k++) gf4_sqr(&tmp[k], &x[k]);
+        for (k=0; k<GF4_BLOCK; k++) gf4_sqr(&y[k], &tmp[k]);
+        n-=2;
+    }
+    for (; n; n-=2) {
+        for (k=0; k<GF4_BLOCK; k++) gf4_sqr(&tmp[k], &y[k]);
+        for (k=0; k<GF4_BLOCK; k++) gf4_sqr(&y[k], &tmp[k]);
+    }
+}
+
+/* Same addition chain as gf_isr, on GF4_BLOCK_LANES elements */
+static void gf_isr_block (
+    gf_25519_t a[GF4_BLOCK_LANES],
+    mask_t succ[GF4_BLOCK_LANES],
+    const gf_25519_t x[GF4_BLOCK_LANES]
+) {
+    gf4_25519_t X[GF4_BLOCK], L0[GF4_BLOCK], L1[GF4_BLOCK], L2[GF4_BLOCK], L3[GF4_BLOCK];
+    gf_25519_t P[GF4_BLOCK_LANES], T0, T1;
+    unsigned int j;
+
+    for (j=0; j<GF4_BLOCK; j++) gf4_load(&X[j], &x[4*j]);
+    gf4_sqrn_block(L0, X, 1);
+    gf4_mul_block (L1, L0, X);
+    gf4_sqrn_block(L0, L1, 1);
+    gf4_mul_block (L1, L0, X);
+    gf4_sqrn_block(L0, L1, 3);
+    gf4_mul_block (L2, L0, L1);
+    gf4_sqrn_block(L0, L2, 6);
+    gf4_mul_block (L1, L2, L0);
+    gf4_sqrn_block(L2, L1, 1);
+    gf4_mul_block (L0, L2, X);
+    gf4_sqrn_block(L2, L0, 12);
+    gf4_mul_block (L0, L2, L1);
+    gf4_sqrn_block(L2, L0, 25);
+    gf4_mul_block (L3, L2, L0);
+    gf4_sqrn_block(L2, L3, 25);
+    gf4_mul_block (L1, L2, L0);
+    gf4_sqrn_block(L2, L1, 50);
+    gf4_mul_block (L0, L2, L3);
+    gf4_sqrn_block(L2, L0, 125);
+    gf4_mul_block (L3, L2, L0);
+    gf4_sqrn_block(L2, L3, 2);
+    gf4_mul_block (L0, L2, X);
+    for (j=0; j<GF4_BLOCK; j++) gf4_store(&P[4*j], &L0[j]);
+
+    /* The checks are cheap, so do them one lane at a time */
+    for (j=0; j<GF4_BLOCK_LANES; j++) {
+        gf_sqr (&T0, &P[j]);
+        gf_mul (&T1, &T0, &x[j]);
+        gf_add(&T0,&T1,&ONE);
+        mask_t one = gf_eq(&T1,&ONE);
+        succ[j] = one | gf_eq(&T0, &ZERO);
+        mask_t qr = one | gf_eq(&T1, &SQRT_MINUS_ONE);
+
+        constant_time_select(&T0, &SQRT_MINUS_ONE, &ONE, sizeof(T0), qr, 0);
+        gf_mul (&a[j],&T0,&P[j]);
+    }
+}
+
+#endif /* __AVX2__ */
+
+void gf_isr_batch (gf_25519_t *a, mask_t *succ, const gf_25519_t *x, size_t n) {
+    size_t i = 0;
+#if __AVX2__
+    /* A block costs about as much as four scalar calls, so pad out any
+     * leftover of five or more lanes.
+     */
+    gf_25519_t xs[GF4_BLOCK_LANES], as[GF4_BLOCK_LANES];
+    mask_t ok[GF4_BLOCK_LANES];
+    unsigned int j;
+    while (n-i > 4) {
+        size_t m = (n-i < GF4_BLOCK_LANES) ? n-i : GF4_BLOCK_LANES;
+        for (j=0; j<GF4_BLOCK_LANES; j++) gf_copy(&xs[j], (j<m) ? &x[i+j] : &ONE);
+        gf_isr_block(as, ok, xs);
+        RISTRETTO_COUNT(gf_isr, m);
+        for (j=0; j<m; j++) {
+            gf_copy(&a[i+j], &as[j]);
+            succ[i+j] = ok[j];
+        }
+        i += m;
+    }
+#endif
+    for (; i<n; i++) succ[i] = gf_isr(&a[i], &x[i]);
+}
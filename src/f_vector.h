@@ -0,0 +1,87 @@
+/**
+ * @file f_vector.h
+ * @author Mike Hamburg
+ *
+ * @copyright
+ *   Copyright (c) 2015-2018 Ristretto Developers, Cryptography Research, Inc.  \n
+ *   Released under the MIT License.  See LICENSE.txt for license information.
+ *
+ * @brief Four-way vectorized arithmetic mod 2^255 - 19.
+ *
+ * Elements are held four to a struct, lane-interleaved: limb i of lane j is
+ * limb[i][j].  The radix is 2^25.5, so that all products are 32x32-bit and
+ * one vpmuludq computes a limb product for all four lanes.  This is slower
+ * than the scalar code for a single element, so it's only used for long,
+ * data-independent sequences like the inverse square root, where there are
+ * four independent elements to work on.
+ */
+
+#ifndef __P25519_F_VECTOR_H__
+#define __P25519_F_VECTOR_H__ 1
+
+#include "field.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if __AVX2__
+
+#define GF4_LIMBS 10
+
+/** Four field elements in radix 2^25.5 */
+typedef struct gf4_25519_s {
+    uint64x4_t limb[GF4_LIMBS];
+} gf4_25519_t;
+
+/** Load four field elements into lanes 0..3 */
+void gf4_load (gf4_25519_t *out, const gf_25519_t in[4]);
+
+/** Store lanes 0..3 to four field elements.  The outputs are weakly reduced. */
+void gf4_store (gf_25519_t out[4], const gf4_25519_t *in);
+
+/** Multiply lanewise.  Outputs are carried, so they may be fed to mul or sqr. */
+void gf4_mul (gf4_25519_t *__restrict__ out, const gf4_25519_t *a, const gf4_25519_t *b);
+
+/** Square lanewise. */
+void gf4_sqr (gf4_25519_t *__restrict__ out, const gf4_25519_t *a);
+
+/** Square lanewise, n times. */
+void gf4_sqrn (gf4_25519_t *__restrict__ y, const gf4_25519_t *x, int n);
+
+/** Add lanewise.  Outputs are carried, like those of mul. */
+void gf4_add (gf4_25519_t *out, const gf4_25519_t *a, const gf4_25519_t *b);
+
+/** Subtract lanewise.  The inputs must be carried. */
+void gf4_sub (gf4_25519_t *out, const gf4_25519_t *a, const gf4_25519_t *b);
+
+/** Multiply lanewise by a small constant, w < 2^20. */
+void gf4_mulw (gf4_25519_t *out, const gf4_25519_t *a, uint32_t w);
+
+/**
+ * Load four weakly reduced field elements stored limb by limb, as in
+ * ristretto255_point_block_t: limb i of lane j is in[i][j].
+ */
+void gf4_load_lanes (gf4_25519_t *out, const ristretto_word_t in[RISTRETTO255_FIELD_LIMBS][4]);
+
+/** Store lanes limb by limb, weakly reduced. */
+void gf4_store_lanes (ristretto_word_t out[RISTRETTO255_FIELD_LIMBS][4], const gf4_25519_t *in);
+
+#endif /* __AVX2__ */
+
+/**
+ * n independent inverse square roots, each exactly as gf_isr.  Uses the
+ * vector unit for blocks of elements if there is one.  a and x may alias.
+ */
+void gf_isr_batch (
+    gf_25519_t *a,
+    mask_t *succ,
+    const gf_25519_t *x,
+    size_t n
+);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* __P25519_F_VECTOR_H__ */
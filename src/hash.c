@@ -0,0 +1,241 @@
+/**
+ * @file hash.c
+ * @author Mike Hamburg
+ *
+ * @copyright
+ *   Copyright (c) 2015-2018 Ristretto Developers, Cryptography Research, Inc.  \n
+ *   Released under the MIT License.  See LICENSE.txt for license information.
+ *
+ * @brief Hashing to the group and to scalars, with expand_message_xmd
+ * (RFC 9380, section 5.3.1) over SHA-512.
+ */
+
+#include <ristretto255.h>
+#include <string.h>
+#include <assert.h>
+#include "sha512.h"
+
+#define XMD_UNIFORM_BYTES (2*RISTRETTO255_HASH_BYTES)
+#define XMD_MAX_BLOCKS 255
+
+/* SHA-512 state after absorbing Z_pad, the all-zero first block */
+static const uint64_t xmd_zpad_state[8] = {
+    0xcf7881d5774acbe8ull, 0x533362e0fbc78070ull, 0x0267639d87460edaull, 0x3086cb40e85931b0ull,
+    0x717dc95288a023a3ull, 0x96bab2c14ce0b5e0ull, 0x6fc4fe04eae33e0bull, 0x91f4d80cbd668beeull
+};
+
+void ristretto255_hash_dst_init (
+    ristretto255_hash_dst_t *dst,
+    const uint8_t *tag,
+    size_t tag_len
+) {
+    static const char oversize[] = "H2C-OVERSIZE-DST-";
+    if (tag_len > RISTRETTO255_HASH_DST_MAX_BYTES) {
+        ristretto255_sha512_ctx_t ctx;
+        ristretto255_sha512_init(&ctx);
+        ristretto255_sha512_update(&ctx, (const uint8_t *)oversize, sizeof(oversize)-1);
+        ristretto255_sha512_update(&ctx, tag, tag_len);
+        ristretto255_sha512_final(&ctx, dst->dst_prime);
+        tag_len = RISTRETTO255_SHA512_OUTPUT_BYTES;
+    } else {
+        memcpy(dst->dst_prime, tag, tag_len);
+    }
+    dst->dst_prime[tag_len] = (uint8_t)tag_len;
+    dst->dst_prime_len = (uint16_t)(tag_len+1);
+}
+
+void ristretto255_hash_init (
+    ristretto255_hash_t *ctx,
+    const ristretto255_hash_dst_t *dst
+) {
+    memcpy(ctx->sha.state, xmd_zpad_state, sizeof(ctx->sha.state));
+    ctx->sha.bytes_processed = RISTRETTO255_SHA512_BLOCK_BYTES;
+    ctx->dst = dst;
+}
+
+void ristretto255_hash_update (
+    ristretto255_hash_t *ctx,
+    const uint8_t *message,
+    size_t message_len
+) {
+    ristretto255_sha512_update(&ctx->sha, message, message_len);
+}
+
+ristretto_error_t ristretto255_hash_final (
+    ristretto255_hash_t *ctx,
+    uint8_t *out,
+    size_t out_len
+) {
+    const ristretto255_hash_dst_t *dst = ctx->dst;
+    uint8_t b0[RISTRETTO255_SHA512_OUTPUT_BYTES], bi[RISTRETTO255_SHA512_OUTPUT_BYTES];
+    uint8_t suffix[3];
+    size_t i, j, blocks = (out_len + RISTRETTO255_SHA512_OUTPUT_BYTES - 1) / RISTRETTO255_SHA512_OUTPUT_BYTES;
+
+    if (blocks > XMD_MAX_BLOCKS) {
+        ristretto_bzero(ctx, sizeof(*ctx));
+        return RISTRETTO_FAILURE;
+    }
+
+    /* b_0 = H(Z_pad || msg || I2OSP(len_in_bytes, 2) || I2OSP(0, 1) || DST_prime) */
+    suffix[0] = (uint8_t)(out_len >> 8);
+    suffix[1] = (uint8_t)out_len;
+    suffix[2] = 0;
+    ristretto255_sha512_update(&ctx->sha, suffix, sizeof(suffix));
+    ristretto255_sha512_update(&ctx->sha, dst->dst_prime, dst->dst_prime_len);
+    ristretto255_sha512_final(&ctx->sha, b0);
+
+    /* b_i = H(strxor(b_0, b_(i-1)) || I2OSP(i, 1) || DST_prime) */
+    memset(bi, 0, sizeof(bi));
+    for (i=1; i<=blocks; i++) {
+        uint8_t counter = (uint8_t)i;
+        size_t take = out_len < sizeof(bi) ? out_len : sizeof(bi);
+        for (j=0; j<sizeof(bi); j++) bi[j] ^= b0[j];
+        ristretto255_sha512_init(&ctx->sha);
+        ristretto255_sha512_update(&ctx->sha, bi, sizeof(bi));
+        ristretto255_sha512_update(&ctx->sha, &counter, 1);
+        ristretto255_sha512_update(&ctx->sha, dst->dst_prime, dst->dst_prime_len);
+        ristretto255_sha512_final(&ctx->sha, bi);
+        memcpy(out, bi, take);
+        out += take;
+        out_len -= take;
+    }
+
+    ristretto_bzero(b0, sizeof(b0));
+    ristretto_bzero(bi, sizeof(bi));
+    ristretto_bzero(ctx, sizeof(*ctx));
+    return RISTRETTO_SUCCESS;
+}
+
+void ristretto255_hash_final_to_group (
+    ristretto255_point_t *pt,
+    ristretto255_hash_t *ctx
+) {
+    uint8_t uniform[XMD_UNIFORM_BYTES];
+    ristretto_error_t ret = ristretto255_hash_final(ctx, uniform, sizeof(uniform));
+    (void)ret;
+    assert(ret == RISTRETTO_SUCCESS);
+    ristretto255_point_from_hash_uniform(pt, uniform);
+    ristretto_bzero(uniform, sizeof(uniform));
+}
+
+void ristretto255_hash_final_to_scalar (
+    ristretto255_scalar_t *out,
+    ristretto255_hash_t *ctx
+) {
+    uint8_t uniform[XMD_UNIFORM_BYTES];
+    ristretto_error_t ret = ristretto255_hash_final(ctx, uniform, sizeof(uniform));
+    (void)ret;
+    assert(ret == RISTRETTO_SUCCESS);
+    ristretto255_scalar_decode_long(out, uniform, sizeof(uniform));
+    ristretto_bzero(uniform, sizeof(uniform));
+}
+
+void ristretto255_hash_to_group (
+    ristretto255_point_t *pt,
+    const uint8_t *message,
+    size_t message_len,
+    const ristretto255_hash_dst_t *dst
+) {
+    ristretto255_hash_t ctx;
+    ristretto255_hash_init(&ctx, dst);
+    ristretto255_hash_update(&ctx, message, message_len);
+    ristretto255_hash_final_to_group(pt, &ctx);
+}
+
+void ristretto255_hash_to_scalar (
+    ristretto255_scalar_t *out,
+    const uint8_t *message,
+    size_t message_len,
+    const ristretto255_hash_dst_t *dst
+) {
+    ristretto255_hash_t ctx;
+    ristretto255_hash_init(&ctx, dst);
+    ristretto255_hash_update(&ctx, message, message_len);
+    ristretto255_hash_final_to_scalar(out, &ctx);
+}
+
+/* Messages hashed per pass before mapping; a multiple of SHA512_MULTI_LANES */
+#define HASH_PIPELINE 8
+
+/* 64 bytes of expand_message_xmd for each of n <= SHA512_MULTI_LANES messages */
+static void xmd_uniform_multi (
+    uint8_t out[][RISTRETTO255_SHA512_OUTPUT_BYTES],
+    const uint8_t *const *messages,
+    const size_t *message_lens,
+    unsigned int n,
+    const ristretto255_hash_dst_t *dst
+) {
+    static const uint8_t suffix[3] = { XMD_UNIFORM_BYTES >> 8, XMD_UNIFORM_BYTES & 0xFF, 0 };
+    static const uint8_t counter = 1;
+    sha512_multi_msg_t msgs[SHA512_MULTI_LANES];
+    uint8_t b0[SHA512_MULTI_LANES][RISTRETTO255_SHA512_OUTPUT_BYTES];
+    unsigned int j;
+
+    /* b_0 = H(Z_pad || msg || I2OSP(64, 2) || I2OSP(0, 1) || DST_prime) */
+    for (j=0; j<n; j++) {
+        msgs[j].part[0] = messages[j];       msgs[j].part_len[0] = message_lens[j];
+        msgs[j].part[1] = suffix;            msgs[j].part_len[1] = sizeof(suffix);
+        msgs[j].part[2] = dst->dst_prime;    msgs[j].part_len[2] = dst->dst_prime_len;
+    }
+    ristretto255_sha512_multi(b0, xmd_zpad_state, RISTRETTO255_SHA512_BLOCK_BYTES, msgs, n);
+
+    /* b_1 = H(b_0 || I2OSP(1, 1) || DST_prime), which is the whole output */
+    for (j=0; j<n; j++) {
+        msgs[j].part[0] = b0[j];             msgs[j].part_len[0] = sizeof(b0[j]);
+        msgs[j].part[1] = &counter;          msgs[j].part_len[1] = 1;
+    }
+    ristretto255_sha512_multi(out, ristretto255_sha512_init_state, 0, msgs, n);
+
+    ristretto_bzero(b0, sizeof(b0));
+}
+
+/* Uniform bytes for messages [0, n), n <= HASH_PIPELINE */
+static void xmd_uniform_pipeline (
+    uint8_t out[HASH_PIPELINE][XMD_UNIFORM_BYTES],
+    const uint8_t *const *messages,
+    const size_t *message_lens,
+    size_t n,
+    const ristretto255_hash_dst_t *dst
+) {
+    size_t i;
+    for (i=0; i<n; i+=SHA512_MULTI_LANES) {
+        size_t m = n-i < SHA512_MULTI_LANES ? n-i : SHA512_MULTI_LANES;
+        xmd_uniform_multi(&out[i], &messages[i], &message_lens[i], (unsigned int)m, dst);
+    }
+}
+
+void ristretto255_hash_to_group_batch (
+    ristretto255_point_t *pts,
+    const uint8_t *const *messages,
+    const size_t *message_lens,
+    size_t n,
+    const ristretto255_hash_dst_t *dst
+) {
+    uint8_t uniform[HASH_PIPELINE][XMD_UNIFORM_BYTES];
+    size_t i;
+
+    for (i=0; i<n; i+=HASH_PIPELINE) {
+        size_t m = n-i < HASH_PIPELINE ? n-i : HASH_PIPELINE;
+        xmd_uniform_pipeline(uniform, &messages[i], &message_lens[i], m, dst);
+        ristretto255_point_from_hash_uniform_batch(&pts[i], &uniform[0][0], m);
+    }
+    ristretto_bzero(uniform, sizeof(uniform));
+}
+
+void ristretto255_hash_to_scalar_batch (
+    ristretto255_scalar_t *out,
+    const uint8_t *const *messages,
+    const size_t *message_lens,
+    size_t n,
+    const ristretto255_hash_dst_t *dst
+) {
+    uint8_t uniform[HASH_PIPELINE][XMD_UNIFORM_BYTES];
+    size_t i, j;
+
+    for (i=0; i<n; i+=HASH_PIPELINE) {
+        size_t m = n-i < HASH_PIPELINE ? n-i : HASH_PIPELINE;
+        xmd_uniform_pipeline(uniform, &messages[i], &message_lens[i], m, dst);
+        for (j=0; j<m; j++) ristretto255_scalar_decode_long(&out[i+j], uniform[j], sizeof(uniform[j]));
+    }
+    ristretto_bzero(uniform, sizeof(uniform));
+}
@@ -0,0 +1,314 @@
+/**
+ * @file key_cache.c
+ * @author Mike Hamburg
+ *
+ * @copyright
+ *   Copyright (c) 2015-2018 Ristretto Developers, Cryptography Research, Inc.  \n
+ *   Released under the MIT License.  See LICENSE.txt for license information.
+ *
+ * @brief A bounded, sharded cache of decoded public keys and their wNAF
+ * tables, for verifiers that see the same keys over and over.
+ */
+
+#include "word.h"
+#include "precomputed_wnaf.h"
+#include <stdlib.h>
+#include <pthread.h>
+
+#define SER_BYTES RISTRETTO255_SER_BYTES
+#define point_t ristretto255_point_t
+#define scalar_t ristretto255_scalar_t
+#define precomputed_wnaf_s ristretto255_precomputed_wnaf_s
+
+/* Independent locks; a power of two */
+#define RISTRETTO_KEY_CACHE_SHARDS 16
+
+/* Slots per set.  A key can only be in the set its hash picks, so lookups
+ * and CLOCK sweeps touch this many slots whatever the capacity. */
+#define RISTRETTO_KEY_CACHE_WAYS 8
+
+typedef struct {
+    point_t point;
+    uint8_t ser[SER_BYTES];
+    uint8_t used, referenced;
+} key_cache_entry_t;
+
+typedef struct {
+    pthread_mutex_t lock;
+    uint64_t hits, misses;
+} key_cache_shard_t;
+
+struct ristretto255_key_cache_s {
+    key_cache_shard_t shard[RISTRETTO_KEY_CACHE_SHARDS];
+    size_t sets; /* per shard */
+
+    /* Set i of shard s is number s*sets+i, and way w of set n is slot
+     * n*RISTRETTO_KEY_CACHE_WAYS+w in tags, entries and tables.  The tags
+     * are the hashes of the encodings. */
+    uint64_t *tags;
+    key_cache_entry_t *entries;
+    uint8_t *tables;
+    uint8_t *hands;
+};
+
+static uint64_t ser_hash (const uint8_t ser[SER_BYTES]) {
+    uint64_t h = 0, word;
+    unsigned int i;
+    for (i=0; i<SER_BYTES; i+=sizeof(word)) {
+        memcpy(&word, &ser[i], sizeof(word));
+        h = (h ^ word) * 0x9e3779b97f4a7c15ull;
+    }
+    return h ^ h>>29;
+}
+
+/* The shard and set for a hash */
+static key_cache_shard_t *shard_of (
+    ristretto255_key_cache_t *cache,
+    uint64_t hash,
+    size_t *set
+) {
+    unsigned int s = hash & (RISTRETTO_KEY_CACHE_SHARDS-1);
+    *set = s*cache->sets + (size_t)((hash / RISTRETTO_KEY_CACHE_SHARDS) % cache->sets);
+    return &cache->shard[s];
+}
+
+static precomputed_wnaf_s *table_of (ristretto255_key_cache_t *cache, size_t slot) {
+    return (precomputed_wnaf_s *)(cache->tables + slot*ristretto255_sizeof_precomputed_wnaf_s);
+}
+
+/* The slot holding ser in the set, or SIZE_MAX if none.  Lock held. */
+static size_t find_locked (
+    const ristretto255_key_cache_t *cache,
+    size_t set,
+    uint64_t hash,
+    const uint8_t ser[SER_BYTES]
+) {
+    size_t slot = set*RISTRETTO_KEY_CACHE_WAYS;
+    unsigned int w;
+    for (w=0; w<RISTRETTO_KEY_CACHE_WAYS; w++, slot++) {
+        const key_cache_entry_t *e = &cache->entries[slot];
+        if (cache->tags[slot] == hash && e->used && !memcmp(e->ser, ser, SER_BYTES)) return slot;
+    }
+    return SIZE_MAX;
+}
+
+/* Install a freshly decoded key, unless another thread beat us to it.  Lock held. */
+static void insert_locked (
+    ristretto255_key_cache_t *cache,
+    size_t set,
+    uint64_t hash,
+    const uint8_t ser[SER_BYTES],
+    const point_t *point,
+    const precomputed_wnaf_s *table
+) {
+    key_cache_entry_t *e;
+    size_t slot;
+    uint8_t *hand = &cache->hands[set];
+
+    if (find_locked(cache, set, hash, ser) != SIZE_MAX) return;
+
+    /* CLOCK within the set: sweep, clearing reference bits, until an
+     * unreferenced slot */
+    for (;; *hand = (*hand+1) % RISTRETTO_KEY_CACHE_WAYS) {
+        slot = set*RISTRETTO_KEY_CACHE_WAYS + *hand;
+        e = &cache->entries[slot];
+        if (!e->used || !e->referenced) break;
+        e->referenced = 0;
+    }
+    *hand = (*hand+1) % RISTRETTO_KEY_CACHE_WAYS;
+
+    memcpy(e->ser, ser, SER_BYTES);
+    ristretto255_point_copy(&e->point, point);
+    memcpy(table_of(cache, slot), table, ristretto255_sizeof_precomputed_wnaf_s);
+    cache->tags[slot] = hash;
+    e->used = 1;
+    e->referenced = 0;
+}
+
+/* Decode ser through the cache, also producing its table if table != NULL */
+static ristretto_error_t key_cache_fetch (
+    point_t *point,
+    precomputed_wnaf_s *table,
+    ristretto255_key_cache_t *cache,
+    const uint8_t ser[SER_BYTES],
+    ristretto_bool_t allow_identity
+) {
+    uint64_t hash = ser_hash(ser);
+    size_t set, slot;
+    key_cache_shard_t *shard = shard_of(cache, hash, &set);
+    ristretto_error_t ret;
+
+    pthread_mutex_lock(&shard->lock);
+    slot = find_locked(cache, set, hash, ser);
+    if (slot != SIZE_MAX) {
+        key_cache_entry_t *e = &cache->entries[slot];
+        ristretto255_point_copy(point, &e->point);
+        if (table) memcpy(table, table_of(cache, slot), ristretto255_sizeof_precomputed_wnaf_s);
+        e->referenced = 1;
+        shard->hits++;
+        pthread_mutex_unlock(&shard->lock);
+        return RISTRETTO_SUCCESS;
+    }
+    shard->misses++;
+    pthread_mutex_unlock(&shard->lock);
+
+    /* Decode and build the table without holding the lock */
+    ret = ristretto255_point_decode(point, ser, allow_identity);
+    if (ret != RISTRETTO_SUCCESS) return ret;
+
+    /* Only non-identity points are cached, so that hits need not recheck
+     * allow_identity */
+    if (ristretto255_point_eq(point, &ristretto255_point_identity)) {
+        if (table) ristretto255_precompute_wnaf(table, point);
+        return ret;
+    }
+
+    {
+        /* The cache keeps a table even if this caller does not want one */
+        precomputed_wnaf_s local, *fresh = table ? table : &local;
+        ristretto255_precompute_wnaf(fresh, point);
+
+        pthread_mutex_lock(&shard->lock);
+        insert_locked(cache, set, hash, ser, point, fresh);
+        pthread_mutex_unlock(&shard->lock);
+    }
+    return ret;
+}
+
+ristretto255_key_cache_t *ristretto255_key_cache_new (
+    size_t capacity
+) {
+    ristretto255_key_cache_t *cache;
+    const size_t per_shard = RISTRETTO_KEY_CACHE_SHARDS * RISTRETTO_KEY_CACHE_WAYS;
+    size_t sets, slots, i;
+    void *mem;
+
+    if (capacity > SIZE_MAX - per_shard) return NULL;
+    sets = (capacity + per_shard - 1) / per_shard;
+    if (sets == 0) sets = 1;
+    if (sets > SIZE_MAX / per_shard / ristretto255_sizeof_precomputed_wnaf_s) return NULL;
+    slots = sets * per_shard;
+
+    cache = (ristretto255_key_cache_t *)calloc(1, sizeof(*cache));
+    if (!cache) return NULL;
+    cache->sets = sets;
+
+    cache->tags = (uint64_t *)calloc(slots, sizeof(uint64_t));
+    cache->hands = (uint8_t *)calloc(sets * RISTRETTO_KEY_CACHE_SHARDS, 1);
+    if (posix_memalign(&mem, ristretto255_alignof_precomputed_s, slots*sizeof(key_cache_entry_t)) == 0) {
+        cache->entries = (key_cache_entry_t *)mem;
+        memset(mem, 0, slots*sizeof(key_cache_entry_t));
+    }
+    if (posix_memalign(&mem, ristretto255_alignof_precomputed_s, slots*ristretto255_sizeof_precomputed_wnaf_s) == 0) {
+        cache->tables = (uint8_t *)mem;
+    }
+
+    for (i=0; i<RISTRETTO_KEY_CACHE_SHARDS; i++) {
+        if (pthread_mutex_init(&cache->shard[i].lock, NULL)) break;
+    }
+    if (i < RISTRETTO_KEY_CACHE_SHARDS || !cache->tags || !cache->entries || !cache->tables || !cache->hands) {
+        while (i--) pthread_mutex_destroy(&cache->shard[i].lock);
+        free(cache->tags);
+        free(cache->hands);
+        free(cache->entries);
+        free(cache->tables);
+        free(cache);
+        return NULL;
+    }
+    return cache;
+}
+
+void ristretto255_key_cache_free (
+    ristretto255_key_cache_t *cache
+) {
+    unsigned int i;
+    if (!cache) return;
+    for (i=0; i<RISTRETTO_KEY_CACHE_SHARDS; i++) pthread_mutex_destroy(&cache->shard[i].lock);
+    free(cache->tags);
+    free(cache->hands);
+    free(cache->entries);
+    free(cache->tables);
+    free(cache);
+}
+
+void ristretto255_key_cache_stats (
+    ristretto255_key_cache_t *cache,
+    uint64_t *hits,
+    uint64_t *misses
+) {
+    unsigned int i;
+    *hits = *misses = 0;
+    for (i=0; i<RISTRETTO_KEY_CACHE_SHARDS; i++) {
+        pthread_mutex_lock(&cache->shard[i].lock);
+        *hits += cache->shard[i].hits;
+        *misses += cache->shard[i].misses;
+        pthread_mutex_unlock(&cache->shard[i].lock);
+    }
+}
+
+ristretto_error_t ristretto255_key_cache_decode (
+    point_t *point,
+    ristretto255_key_cache_t *cache,
+    const uint8_t ser[SER_BYTES],
+    ristretto_bool_t allow_identity
+) {
+    return key_cache_fetch(point, NULL, cache, ser, allow_identity);
+}
+
+ristretto_error_t ristretto255_key_cache_scalarmul_non_secret_ws (
+    point_t *scaled,
+    ristretto255_key_cache_t *cache,
+    const uint8_t base[SER_BYTES],
+    const scalar_t *scalar,
+    ristretto_bool_t allow_identity,
+    void *workspace
+) {
+    precomputed_wnaf_s *table = (precomputed_wnaf_s *)workspace;
+    point_t point;
+    ristretto_error_t ret = key_cache_fetch(&point, table, cache, base, allow_identity);
+    if (ret == RISTRETTO_SUCCESS) {
+        ristretto255_precomputed_wnaf_scalarmul_non_secret(scaled, table, scalar);
+    }
+    return ret;
+}
+
+ristretto_error_t ristretto255_key_cache_base_double_scalarmul_non_secret_ws (
+    point_t *combo,
+    ristretto255_key_cache_t *cache,
+    const scalar_t *scalar1,
+    const uint8_t base2[SER_BYTES],
+    const scalar_t *scalar2,
+    ristretto_bool_t allow_identity,
+    void *workspace
+) {
+    precomputed_wnaf_s *table = (precomputed_wnaf_s *)workspace;
+    point_t point;
+    ristretto_error_t ret = key_cache_fetch(&point, table, cache, base2, allow_identity);
+    if (ret == RISTRETTO_SUCCESS) {
+        ristretto255_precomputed_wnaf_base_double_scalarmul_non_secret(combo, scalar1, table, scalar2);
+    }
+    return ret;
+}
+
+ristretto_error_t ristretto255_key_cache_scalarmul_non_secret (
+    point_t *scaled,
+    ristretto255_key_cache_t *cache,
+    const uint8_t base[SER_BYTES],
+    const scalar_t *scalar,
+    ristretto_bool_t allow_identity
+) {
+    precomputed_wnaf_s table;
+    return ristretto255_key_cache_scalarmul_non_secret_ws(scaled, cache, base, scalar, allow_identity, &table);
+}
+
+ristretto_error_t ristretto255_key_cache_base_double_scalarmul_non_secret (
+    point_t *combo,
+    ristretto255_key_cache_t *cache,
+    const scalar_t *scalar1,
+    const uint8_t base2[SER_BYTES],
+    const scalar_t *scalar2,
+    ristretto_bool_t allow_identity
+) {
+    precomputed_wnaf_s table;
+    return ristretto255_key_cache_base_double_scalarmul_non_secret_ws(combo, cache, scalar1, base2, scalar2, allow_identity, &table);
+}
@@ -0,0 +1,26 @@
+/**
+ * @file precomputed_wnaf.h
+ * @copyright
+ *   Copyright (c) 2015-2018 Ristretto Developers, Cryptography Research, Inc.  \n
+ *   Released under the MIT License.  See LICENSE.txt for license information.
+ * @author Mike Hamburg
+ * @brief The wNAF table layout, so that the key cache can keep one on the
+ * stack.
+ */
+
+#ifndef __RISTRETTO_PRECOMPUTED_WNAF_H__
+#define __RISTRETTO_PRECOMPUTED_WNAF_H__ 1
+
+#include <ristretto255.h>
+#include "word.h"
+#include "field.h"
+#include "ristretto_config.h"
+
+/* Projective Niels coordinates */
+typedef struct { gf_25519_t a, b, c; } niels_t;
+typedef struct { niels_t n; gf_25519_t z; } VECTOR_ALIGNED pniels_t;
+
+/* Odd multiples P, 3P, ..., for variable-time scalarmul by a fixed point */
+struct ristretto255_precomputed_wnaf_s { pniels_t table [1<<RISTRETTO_WNAF_SINGLE_TABLE_BITS]; };
+
+#endif /* __RISTRETTO_PRECOMPUTED_WNAF_H__ */
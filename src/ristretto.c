@@ -14,6 +14,10 @@
 #include <ristretto255.h>
 #include "word.h"
 #include "field.h"
+#include "f_vector.h"
+#include "ristretto_config.h"
+#include "precomputed_wnaf.h"
+#include <pthread.h>
 
 #define SCALAR_BITS RISTRETTO255_SCALAR_BITS
 #define SCALAR_SER_BYTES RISTRETTO255_SCALAR_BYTES
@@ -21,21 +25,15 @@
 #define scalar_t ristretto255_scalar_t
 #define point_t ristretto255_point_t
 #define precomputed_s ristretto255_precomputed_s
+#define precomputed_wnaf_s ristretto255_precomputed_wnaf_s
 
-/* Comb config: number of combs, n, t, s. */
-#define COMBS_N 3
-#define COMBS_T 5
-#define COMBS_S 17
-#define RISTRETTO_WINDOW_BITS 4
-#define RISTRETTO_WNAF_FIXED_TABLE_BITS 5
-#define RISTRETTO_WNAF_VAR_TABLE_BITS 3
+#define COMBS_ENTRIES (COMBS_N<<(COMBS_T-1))
 
 const int RISTRETTO255_EDWARDS_D = -121665;
-static const scalar_t point_scalarmul_adjustment = {{
-    SC_LIMB(0xd6ec31748d98951c), SC_LIMB(0xc6ef5bf4737dcf70), SC_LIMB(0xfffffffffffffffe), SC_LIMB(0x0fffffffffffffff)
-}}, precomputed_scalarmul_adjustment = {{
-    SC_LIMB(0x977f4a4775473484), SC_LIMB(0x6de72ae98b3ab623), SC_LIMB(0xffffffffffffffff), SC_LIMB(0x0fffffffffffffff)
-}};
+/* Generated by ristretto_gen_tables to match ristretto_config.h */
+extern const scalar_t ristretto255_point_scalarmul_adjustment, ristretto255_precomputed_scalarmul_adjustment;
+#define point_scalarmul_adjustment ristretto255_point_scalarmul_adjustment
+#define precomputed_scalarmul_adjustment ristretto255_precomputed_scalarmul_adjustment
 
 const gf_25519_t RISTRETTO255_FACTOR = FIELD_LITERAL(
     0x702557fa2bf03, 0x514b7d1a82cc6, 0x7f89efd8b43a7, 0x1aef49ec23700, 0x079376fa30500
@@ -49,19 +47,53 @@ extern const gf_25519_t SQRT_MINUS_ONE;
 
 extern const point_t ristretto255_point_base;
 
-/* Projective Niels coordinates */
-typedef struct { gf_25519_t a, b, c; } niels_t;
-typedef struct { niels_t n; gf_25519_t z; } VECTOR_ALIGNED pniels_t;
+/* The same as table entries for constant_time_lookup_aligned: the limbs
+ * without the padding of each gf_25519_t, zero-padded to whole lookup
+ * registers.  A niels entry is 128 bytes rather than 192.
+ */
+#define GF_LIMBS (sizeof(((gf_25519_t *)0)->limb)/sizeof(ristretto_word_t))
+#define LOOKUP_WORDS(n) (((n)*sizeof(ristretto_word_t) + sizeof(lookup_register_t) - 1) \
+    / sizeof(lookup_register_t) * sizeof(lookup_register_t) / sizeof(ristretto_word_t))
+typedef struct { ristretto_word_t limb[LOOKUP_WORDS(3*GF_LIMBS)]; } LOOKUP_ALIGNED niels_packed_t;
+typedef struct { ristretto_word_t limb[LOOKUP_WORDS(4*GF_LIMBS)]; } LOOKUP_ALIGNED pniels_packed_t;
+
+/* Comb entries: packed niels, or with RISTRETTO_COMPACT_COMBS, the
+ * coordinates serialized.  They are only touched through pack_comb,
+ * unpack_comb and constant_time_lookup_niels.
+ */
+#if RISTRETTO_COMPACT_COMBS
+typedef struct { uint8_t a[SER_BYTES], b[SER_BYTES], c[SER_BYTES]; } VECTOR_ALIGNED niels_comb_t;
+#else
+typedef niels_packed_t niels_comb_t;
+#endif
 
 /* Precomputed base */
-struct precomputed_s { niels_t table [COMBS_N<<(COMBS_T-1)]; };
+struct precomputed_s { niels_comb_t table [COMBS_N<<(COMBS_T-1)]; };
 
-extern const gf_25519_t ristretto255_precomputed_base_as_fe[];
+extern const ristretto_word_t ristretto255_precomputed_base_as_words[];
 const precomputed_s *ristretto255_precomputed_base =
-    (const precomputed_s *) &ristretto255_precomputed_base_as_fe;
+    (const precomputed_s *) &ristretto255_precomputed_base_as_words;
 
 const size_t ristretto255_sizeof_precomputed_s = sizeof(precomputed_s);
-const size_t ristretto255_alignof_precomputed_s = sizeof(big_register_t);
+const size_t ristretto255_alignof_precomputed_s =
+    sizeof(lookup_register_t) > sizeof(big_register_t) ? sizeof(lookup_register_t) : sizeof(big_register_t);
+
+const size_t ristretto255_sizeof_precomputed_wnaf_s = sizeof(precomputed_wnaf_s);
+
+size_t ristretto255_workspace_size (
+    ristretto255_workspace_op_t op,
+    size_t n
+) {
+    switch (op) {
+    case RISTRETTO255_WS_PRECOMPUTE_BATCH:
+        if (n > SIZE_MAX / (2*COMBS_ENTRIES*sizeof(gf_25519_t))) return 0;
+        return n * 2*COMBS_ENTRIES*sizeof(gf_25519_t);
+    case RISTRETTO255_WS_KEY_CACHE:
+        return sizeof(precomputed_wnaf_s);
+    default:
+        return 0;
+    }
+}
 
 /** Inverse. */
 static void
@@ -89,29 +121,63 @@ void ristretto255_deisogenize (
     mask_t toggle_altx,
     mask_t toggle_rotation
 );
+void ristretto255_deisogenize_isr_input (
+    gf_25519_t *x,
+    gf_25519_t *num,
+    gf_25519_t *den,
+    const point_t *p
+);
+void ristretto255_deisogenize_finish (
+    gf_25519_t *__restrict__ s,
+    gf_25519_t *__restrict__ inv_el_sum,
+    gf_25519_t *__restrict__ inv_el_m1,
+    const point_t *p,
+    const gf_25519_t *num,
+    const gf_25519_t *den,
+    const gf_25519_t *isr,
+    mask_t toggle_s,
+    mask_t toggle_altx,
+    mask_t toggle_rotation
+);
 
-void ristretto255_deisogenize (
+/* The part of deisogenize which doesn't depend on the toggles: the value
+ * num*(a-d)*den^2 whose inverse square root it takes, and num and den for
+ * the finish */
+void ristretto255_deisogenize_isr_input (
+    gf_25519_t *x,
+    gf_25519_t *num,
+    gf_25519_t *den,
+    const point_t *p
+) {
+    gf_25519_t t1,t2;
+    gf_add(&t1,&p->z,&p->y);
+    gf_sub(&t2,&p->z,&p->y);
+    gf_mul(num,&t1,&t2);
+    gf_mul(den,&p->x,&p->y);
+    gf_sqr(&t1,den);
+    gf_mul(&t2,&t1,num);
+    gf_mulw(x,&t2,-1-TWISTED_D);
+}
+
+/* The rest of deisogenize, given num, den and isqrt(num*(a-d)*den^2) */
+void ristretto255_deisogenize_finish (
     gf_25519_t *__restrict__ s,
     gf_25519_t *__restrict__ inv_el_sum,
     gf_25519_t *__restrict__ inv_el_m1,
     const point_t *p,
+    const gf_25519_t *num,
+    const gf_25519_t *den,
+    const gf_25519_t *isr,
     mask_t toggle_s,
     mask_t toggle_altx,
     mask_t toggle_rotation
 ) {
     /* More complicated because of rotation */
     gf_25519_t t1,t2,t3,t4,t5;
-    gf_add(&t1,&p->z,&p->y);
-    gf_sub(&t2,&p->z,&p->y);
-    gf_mul(&t3,&t1,&t2);     /* t3 = num */
-    gf_mul(&t2,&p->x,&p->y); /* t2 = den */
-    gf_sqr(&t1,&t2);
-    gf_mul(&t4,&t1,&t3);
-    gf_mulw(&t1,&t4,-1-TWISTED_D);
-    gf_isr(&t4,&t1);         /* isqrt(num*(a-d)*den^2) */
-    gf_mul(&t1,&t2,&t4);
+    gf_copy(&t4,isr);
+    gf_mul(&t1,den,&t4);
     gf_mul(&t2,&t1,&RISTRETTO255_FACTOR); /* t2 = "iden" in ristretto.sage */
-    gf_mul(&t1,&t3,&t4);                  /* t1 = "inum" in ristretto.sage */
+    gf_mul(&t1,num,&t4);                  /* t1 = "inum" in ristretto.sage */
 
     /* Calculate altxy = iden*inum*i*t^2*(d-a) */
     gf_mul(&t3,&t1,&t2);
@@ -147,47 +213,77 @@ void ristretto255_deisogenize (
     gf_sub(inv_el_m1,inv_el_m1,&t4);
 }
 
+void ristretto255_deisogenize (
+    gf_25519_t *__restrict__ s,
+    gf_25519_t *__restrict__ inv_el_sum,
+    gf_25519_t *__restrict__ inv_el_m1,
+    const point_t *p,
+    mask_t toggle_s,
+    mask_t toggle_altx,
+    mask_t toggle_rotation
+) {
+    gf_25519_t isr, num, den;
+    ristretto255_deisogenize_isr_input(&isr,&num,&den,p);
+    gf_isr(&isr,&isr);
+    ristretto255_deisogenize_finish(s,inv_el_sum,inv_el_m1,p,&num,&den,&isr,toggle_s,toggle_altx,toggle_rotation);
+}
+
 void ristretto255_point_encode( unsigned char ser[SER_BYTES], const point_t *p ) {
     gf_25519_t s,ie1,ie2;
     ristretto255_deisogenize(&s,&ie1,&ie2,p,0,0,0);
     gf_serialize(ser,&s,1);
 }
 
-ristretto_error_t ristretto255_point_decode (
-    point_t *p,
+/* The part of decode before its inverse square root */
+typedef struct { gf_25519_t s, num, den, ynum; mask_t succ; } decode_state_t;
+
+/* Deserialize s and compute num*den^2, whose inverse square root decode takes */
+static void point_decode_prepare (
+    decode_state_t *st,
+    gf_25519_t *isr_input,
     const unsigned char ser[SER_BYTES],
     ristretto_bool_t allow_identity
 ) {
-    gf_25519_t s, s2, num, tmp;
-    gf_25519_t *tmp2=&s2, *ynum=&p->z, *isr=&p->x, *den=&p->t;
+    gf_25519_t s2, tmp;
 
-    mask_t succ = gf_deserialize(&s, ser, 1, 0);
-    succ &= bool_to_mask(allow_identity) | ~gf_eq(&s, &ZERO);
-    succ &= ~gf_lobit(&s);
+    st->succ = gf_deserialize(&st->s, ser, 1, 0);
+    st->succ &= bool_to_mask(allow_identity) | ~gf_eq(&st->s, &ZERO);
+    st->succ &= ~gf_lobit(&st->s);
 
-    gf_sqr(&s2,&s);                  /* s^2 = -as^2 */
+    gf_sqr(&s2,&st->s);              /* s^2 = -as^2 */
     gf_sub(&s2,&ZERO,&s2);           /* -as^2 */
-    gf_sub(den,&ONE,&s2);            /* 1+as^2 */
-    gf_add(ynum,&ONE,&s2);           /* 1-as^2 */
-    gf_mulw(&num,&s2,-4*TWISTED_D);
-    gf_sqr(&tmp,den);                /* tmp = den^2 */
-    gf_add(&num,&tmp,&num);          /* num = den^2 - 4*d*s^2 */
-    gf_mul(tmp2,&num,&tmp);          /* tmp2 = num*den^2 */
-    succ &= gf_isr(isr,tmp2);        /* isr = 1/sqrt(num*den^2) */
-    gf_mul(&tmp,isr,den);            /* isr*den */
-    gf_mul(&p->y,&tmp,ynum);         /* isr*den*(1-as^2) */
-    gf_mul(tmp2,&tmp,&s);            /* s*isr*den */
-    gf_add(tmp2,tmp2,tmp2);          /* 2*s*isr*den */
-    gf_mul(&tmp,tmp2,isr);           /* 2*s*isr^2*den */
-    gf_mul(&p->x,&tmp,&num);         /* 2*s*isr^2*den*num */
-    gf_mul(&tmp,tmp2,&RISTRETTO255_FACTOR); /* 2*s*isr*den*magic */
+    gf_sub(&st->den,&ONE,&s2);       /* 1+as^2 */
+    gf_add(&st->ynum,&ONE,&s2);      /* 1-as^2 */
+    gf_mulw(&st->num,&s2,-4*TWISTED_D);
+    gf_sqr(&tmp,&st->den);           /* tmp = den^2 */
+    gf_add(&st->num,&tmp,&st->num);  /* num = den^2 - 4*d*s^2 */
+    gf_mul(isr_input,&st->num,&tmp); /* num*den^2 */
+}
+
+/* The rest of decode, given isr = 1/sqrt(num*den^2) and whether it exists */
+static mask_t point_decode_finish (
+    point_t *p,
+    decode_state_t *st,
+    const gf_25519_t *isr,
+    mask_t square
+) {
+    gf_25519_t tmp, tmp2;
+    mask_t succ = st->succ & square;
+
+    gf_mul(&tmp,isr,&st->den);       /* isr*den */
+    gf_mul(&p->y,&tmp,&st->ynum);    /* isr*den*(1-as^2) */
+    gf_mul(&tmp2,&tmp,&st->s);       /* s*isr*den */
+    gf_add(&tmp2,&tmp2,&tmp2);       /* 2*s*isr*den */
+    gf_mul(&tmp,&tmp2,isr);          /* 2*s*isr^2*den */
+    gf_mul(&p->x,&tmp,&st->num);     /* 2*s*isr^2*den*num */
+    gf_mul(&tmp,&tmp2,&RISTRETTO255_FACTOR); /* 2*s*isr*den*magic */
     gf_cond_neg(&p->x,gf_lobit(&tmp)); /* flip x */
 
     /* Additionally check y != 0 and x*y*isomagic nonegative */
     succ &= ~gf_eq(&p->y,&ZERO);
     gf_mul(&tmp,&p->x,&p->y);
-    gf_mul(tmp2,&tmp,&RISTRETTO255_FACTOR);
-    succ &= ~gf_lobit(tmp2);
+    gf_mul(&tmp2,&tmp,&RISTRETTO255_FACTOR);
+    succ &= ~gf_lobit(&tmp2);
 
     gf_copy(&tmp,&p->x);
     gf_mul_i(&p->x,&tmp);
@@ -197,6 +293,22 @@ ristretto_error_t ristretto255_point_decode (
     gf_mul(&p->t,&p->x,&p->y);
 
     assert(ristretto255_point_valid(p) | ~succ);
+    return succ;
+}
+
+ristretto_error_t ristretto255_point_decode (
+    point_t *p,
+    const unsigned char ser[SER_BYTES],
+    ristretto_bool_t allow_identity
+) {
+    decode_state_t st;
+    gf_25519_t isr, tmp;
+    mask_t square, succ;
+
+    point_decode_prepare(&st, &tmp, ser, allow_identity);
+    square = gf_isr(&isr,&tmp);      /* isr = 1/sqrt(num*den^2) */
+    succ = point_decode_finish(p, &st, &isr, square);
+    ristretto_bzero(&st, sizeof(st));
     return ristretto_succeed_if(mask_to_bool(succ));
 }
 
@@ -206,6 +318,7 @@ void ristretto255_point_sub (
     const point_t *r
 ) {
     gf_25519_t a, b, c, d;
+    RISTRETTO_COUNT(point_add, 1);
     gf_sub_nr ( &b, &q->y, &q->x ); /* 3+e */
     gf_sub_nr ( &d, &r->y, &r->x ); /* 3+e */
     gf_add_nr ( &c, &r->y, &r->x ); /* 2+e */
@@ -233,6 +346,7 @@ void ristretto255_point_add (
     const point_t *r
 ) {
     gf_25519_t a, b, c, d;
+    RISTRETTO_COUNT(point_add, 1);
     gf_sub_nr ( &b, &q->y, &q->x ); /* 3+e */
     gf_sub_nr ( &c, &r->y, &r->x ); /* 3+e */
     gf_add_nr ( &d, &r->y, &r->x ); /* 2+e */
@@ -261,6 +375,7 @@ point_double_internal (
     int before_double
 ) {
     gf_25519_t a, b, c, d;
+    RISTRETTO_COUNT(point_double, 1);
     gf_sqr ( &c, &q->x );
     gf_sqr ( &a, &q->y );
     gf_add_nr ( &d, &c, &a );             /* 2+e */
@@ -302,6 +417,85 @@ cond_neg_niels (
     gf_cond_neg(&n->c, neg);
 }
 
+static RISTRETTO_INLINE void
+pack_niels (
+    niels_packed_t *out,
+    const niels_t *n
+) {
+    memcpy(&out->limb[0], n->a.limb, sizeof(n->a.limb));
+    memcpy(&out->limb[GF_LIMBS], n->b.limb, sizeof(n->b.limb));
+    memcpy(&out->limb[2*GF_LIMBS], n->c.limb, sizeof(n->c.limb));
+    memset(&out->limb[3*GF_LIMBS], 0, sizeof(out->limb) - 3*sizeof(n->a.limb));
+}
+
+static RISTRETTO_INLINE void
+unpack_niels (
+    niels_t *n,
+    const niels_packed_t *in
+) {
+    memcpy(n->a.limb, &in->limb[0], sizeof(n->a.limb));
+    memcpy(n->b.limb, &in->limb[GF_LIMBS], sizeof(n->b.limb));
+    memcpy(n->c.limb, &in->limb[2*GF_LIMBS], sizeof(n->c.limb));
+}
+
+static RISTRETTO_INLINE void
+pack_comb (
+    niels_comb_t *out,
+    const niels_t *n
+) {
+#if RISTRETTO_COMPACT_COMBS
+    gf_serialize(out->a, &n->a, 1);
+    gf_serialize(out->b, &n->b, 1);
+    gf_serialize(out->c, &n->c, 1);
+#else
+    pack_niels(out, n);
+#endif
+}
+
+static RISTRETTO_INLINE void
+unpack_comb (
+    niels_t *n,
+    const niels_comb_t *in
+) {
+#if RISTRETTO_COMPACT_COMBS
+    gf_deserialize_canonical(&n->a, in->a);
+    gf_deserialize_canonical(&n->b, in->b);
+    gf_deserialize_canonical(&n->c, in->c);
+#else
+    unpack_niels(n, in);
+#endif
+}
+
+static RISTRETTO_INLINE void
+pack_pniels (
+    pniels_packed_t *out,
+    const pniels_t *pn
+) {
+    memcpy(&out->limb[0], pn->n.a.limb, sizeof(pn->n.a.limb));
+    memcpy(&out->limb[GF_LIMBS], pn->n.b.limb, sizeof(pn->n.b.limb));
+    memcpy(&out->limb[2*GF_LIMBS], pn->n.c.limb, sizeof(pn->n.c.limb));
+    memcpy(&out->limb[3*GF_LIMBS], pn->z.limb, sizeof(pn->z.limb));
+    memset(&out->limb[4*GF_LIMBS], 0, sizeof(out->limb) - 4*sizeof(pn->z.limb));
+}
+
+/* pn = table[idx] in constant time.  The entry passes through packed,
+ * which the caller clears along with pn.
+ */
+static RISTRETTO_INLINE void
+constant_time_lookup_pniels (
+    pniels_t *__restrict__ pn,
+    pniels_packed_t *__restrict__ packed,
+    const pniels_packed_t *table,
+    int nelts,
+    word_t idx
+) {
+    constant_time_lookup_aligned(packed, table, sizeof(*packed), nelts, idx);
+    memcpy(pn->n.a.limb, &packed->limb[0], sizeof(pn->n.a.limb));
+    memcpy(pn->n.b.limb, &packed->limb[GF_LIMBS], sizeof(pn->n.b.limb));
+    memcpy(pn->n.c.limb, &packed->limb[2*GF_LIMBS], sizeof(pn->n.c.limb));
+    memcpy(pn->z.limb, &packed->limb[3*GF_LIMBS], sizeof(pn->z.limb));
+}
+
 static RISTRETTO_NOINLINE void pt_to_pniels (
     pniels_t *b,
     const point_t *a
@@ -343,6 +537,7 @@ add_niels_to_pt (
     int before_double
 ) {
     gf_25519_t a, b, c;
+    RISTRETTO_COUNT(point_add, 1);
     gf_sub_nr ( &b, &d->y, &d->x ); /* 3+e */
     gf_mul ( &a, &e->a, &b );
     gf_add_nr ( &b, &d->x, &d->y ); /* 2+e */
@@ -365,6 +560,7 @@ sub_niels_from_pt (
     int before_double
 ) {
     gf_25519_t a, b, c;
+    RISTRETTO_COUNT(point_add, 1);
     gf_sub_nr ( &b, &d->y, &d->x ); /* 3+e */
     gf_mul ( &a, &e->b, &b );
     gf_add_nr ( &b, &d->x, &d->y ); /* 2+e */
@@ -406,24 +602,27 @@ sub_pniels_from_pt (
 
 static RISTRETTO_NOINLINE void
 prepare_fixed_window(
-    pniels_t *multiples,
+    pniels_packed_t *multiples,
     const point_t *b,
     int ntable
 ) {
     point_t tmp;
-    pniels_t pn;
+    pniels_t pn, multiple;
     int i;
 
     point_double_internal(&tmp, b, 0);
     pt_to_pniels(&pn, &tmp);
-    pt_to_pniels(&multiples[0], b);
+    pt_to_pniels(&multiple, b);
+    pack_pniels(&multiples[0], &multiple);
     ristretto255_point_copy(&tmp, b);
     for (i=1; i<ntable; i++) {
         add_pniels_to_pt(&tmp, &pn, 0);
-        pt_to_pniels(&multiples[i], &tmp);
+        pt_to_pniels(&multiple, &tmp);
+        pack_pniels(&multiples[i], &multiple);
     }
 
     ristretto_bzero(&pn,sizeof(pn));
+    ristretto_bzero(&multiple,sizeof(multiple));
     ristretto_bzero(&tmp,sizeof(tmp));
 }
 
@@ -442,7 +641,8 @@ void ristretto255_point_scalarmul (
     ristretto255_scalar_halve(&scalar1x,&scalar1x);
 
     /* Set up a precomputed table with odd multiples of b. */
-    pniels_t pn, multiples[1<<((int)(RISTRETTO_WINDOW_BITS)-1)];  // == NTABLE (MSVC compatibility issue)
+    pniels_t pn;
+    pniels_packed_t packed, multiples[1<<((int)(RISTRETTO_WINDOW_BITS)-1)];  // == NTABLE (MSVC compatibility issue)
     point_t tmp;
     prepare_fixed_window(multiples, b, NTABLE);
 
@@ -461,7 +661,7 @@ void ristretto255_point_scalarmul (
         bits ^= inv;
 
         /* Add in from table.  Compute t only on last iteration. */
-        constant_time_lookup(&pn, multiples, sizeof(pn), NTABLE, bits & WINDOW_T_MASK);
+        constant_time_lookup_pniels(&pn, &packed, multiples, NTABLE, bits & WINDOW_T_MASK);
         cond_neg_niels(&pn.n, inv);
         if (first) {
             pniels_to_pt(&tmp, &pn);
@@ -483,6 +683,7 @@ void ristretto255_point_scalarmul (
 
     ristretto_bzero(&scalar1x,sizeof(scalar1x));
     ristretto_bzero(&pn,sizeof(pn));
+    ristretto_bzero(&packed,sizeof(packed));
     ristretto_bzero(&multiples,sizeof(multiples));
     ristretto_bzero(&tmp,sizeof(tmp));
 }
@@ -507,7 +708,8 @@ void ristretto255_point_double_scalarmul (
     ristretto255_scalar_halve(&scalar2x,&scalar2x);
 
     /* Set up a precomputed table with odd multiples of b. */
-    pniels_t pn, multiples1[1<<((int)(RISTRETTO_WINDOW_BITS)-1)], multiples2[1<<((int)(RISTRETTO_WINDOW_BITS)-1)];
+    pniels_t pn;
+    pniels_packed_t packed, multiples1[1<<((int)(RISTRETTO_WINDOW_BITS)-1)], multiples2[1<<((int)(RISTRETTO_WINDOW_BITS)-1)];
     // Array size above equal NTABLE (MSVC compatibility issue)
     point_t tmp;
     prepare_fixed_window(multiples1, b, NTABLE);
@@ -533,7 +735,7 @@ void ristretto255_point_double_scalarmul (
         bits2 ^= inv2;
 
         /* Add in from table.  Compute t only on last iteration. */
-        constant_time_lookup(&pn, multiples1, sizeof(pn), NTABLE, bits1 & WINDOW_T_MASK);
+        constant_time_lookup_pniels(&pn, &packed, multiples1, NTABLE, bits1 & WINDOW_T_MASK);
         cond_neg_niels(&pn.n, inv1);
         if (first) {
             pniels_to_pt(&tmp, &pn);
@@ -548,7 +750,7 @@ void ristretto255_point_double_scalarmul (
             point_double_internal(&tmp, &tmp, 0);
             add_pniels_to_pt(&tmp, &pn, 0);
         }
-        constant_time_lookup(&pn, multiples2, sizeof(pn), NTABLE, bits2 & WINDOW_T_MASK);
+        constant_time_lookup_pniels(&pn, &packed, multiples2, NTABLE, bits2 & WINDOW_T_MASK);
         cond_neg_niels(&pn.n, inv2);
         add_pniels_to_pt(&tmp, &pn, i?-1:0);
     }
@@ -560,6 +762,7 @@ void ristretto255_point_double_scalarmul (
     ristretto_bzero(&scalar1x,sizeof(scalar1x));
     ristretto_bzero(&scalar2x,sizeof(scalar2x));
     ristretto_bzero(&pn,sizeof(pn));
+    ristretto_bzero(&packed,sizeof(packed));
     ristretto_bzero(&multiples1,sizeof(multiples1));
     ristretto_bzero(&multiples2,sizeof(multiples2));
     ristretto_bzero(&tmp,sizeof(tmp));
@@ -669,6 +872,177 @@ void ristretto255_point_dual_scalarmul (
     ristretto_bzero(&working,sizeof(working));
 }
 
+/* 2^(WINDOW*i) * base for each window i */
+static void prepare_window_powers (
+    pniels_t *powers, /* [NWINDOWS] */
+    const point_t *base
+) {
+    const int WINDOW = RISTRETTO_WINDOW_BITS,
+        NWINDOWS = (SCALAR_BITS+WINDOW-1)/WINDOW;
+    point_t working;
+    int i,j;
+
+    ristretto255_point_copy(&working, base);
+    for (i=0; i<NWINDOWS; i++) {
+        if (i) {
+            for (j=0; j<WINDOW-1; j++)
+                point_double_internal(&working, &working, -1);
+            point_double_internal(&working, &working, 0);
+        }
+        pt_to_pniels(&powers[i], &working);
+    }
+    ristretto255_point_destroy(&working);
+}
+
+/* out = sum of (2i+1)*buckets[i].  Clobbers buckets. */
+static void sum_odd_buckets (
+    point_t *out,
+    point_t *buckets /* [NTABLE] */
+) {
+    const int NTABLE = 1<<(RISTRETTO_WINDOW_BITS-1);
+    point_t working;
+    int i;
+
+    if (NTABLE > 1) {
+        ristretto255_point_copy(&working, &buckets[NTABLE-1]);
+
+        for (i=NTABLE-1; i>1; i--) {
+            ristretto255_point_add(&buckets[i-1], &buckets[i-1], &buckets[i]);
+            ristretto255_point_add(&working, &working, &buckets[i-1]);
+        }
+
+        ristretto255_point_add(&buckets[0], &buckets[0], &buckets[1]);
+        point_double_internal(&working, &working, 0);
+        ristretto255_point_add(out, &working, &buckets[0]);
+    } else {
+        ristretto255_point_copy(out, &buckets[0]);
+    }
+    ristretto255_point_destroy(&working);
+}
+
+/* Signed odd window digit i of an adjusted, halved scalar: the bucket index,
+ * and all ones if it is negative */
+static RISTRETTO_INLINE word_t window_digit (
+    mask_t *inv,
+    const scalar_t *scalar1x,
+    int i
+) {
+    const int WINDOW = RISTRETTO_WINDOW_BITS,
+        WINDOW_MASK = (1<<WINDOW)-1,
+        WINDOW_T_MASK = WINDOW_MASK >> 1;
+    int bit = i*WINDOW;
+
+    word_t bits = scalar1x->limb[bit/WBITS] >> (bit%WBITS);
+    if (bit%WBITS >= WBITS-WINDOW && bit/WBITS<SCALAR_LIMBS-1) {
+        bits ^= scalar1x->limb[bit/WBITS+1] << (WBITS - (bit%WBITS));
+    }
+    bits &= WINDOW_MASK;
+    *inv = (bits>>(WINDOW-1))-1;
+    return (bits ^ *inv) & WINDOW_T_MASK;
+}
+
+void ristretto255_point_scalarmul_multiples (
+    point_t *scaled,
+    const point_t *base,
+    const scalar_t *scalars,
+    size_t n
+) {
+    const int WINDOW = RISTRETTO_WINDOW_BITS,
+        NTABLE = 1<<(WINDOW-1),
+        NWINDOWS = (SCALAR_BITS+WINDOW-1)/WINDOW;
+
+    /* As dual_scalarmul, but with the doublings of the base computed once */
+    pniels_t pn, powers[(SCALAR_BITS+RISTRETTO_WINDOW_BITS-1)/RISTRETTO_WINDOW_BITS]; // == NWINDOWS
+    point_t buckets[1<<((int)(RISTRETTO_WINDOW_BITS)-1)], tmp;
+    // Array size above equals NTABLE (MSVC compatibility issue)
+    scalar_t scalar1x;
+    int i;
+    size_t k;
+
+    prepare_window_powers(powers, base);
+
+    for (k=0; k<n; k++) {
+        ristretto255_scalar_add(&scalar1x, &scalars[k], &point_scalarmul_adjustment);
+        ristretto255_scalar_halve(&scalar1x,&scalar1x);
+
+        for (i=0; i<NTABLE; i++) {
+            ristretto255_point_copy(&buckets[i], &ristretto255_point_identity);
+        }
+
+        for (i=0; i<NWINDOWS; i++) {
+            mask_t inv;
+            word_t index = window_digit(&inv, &scalar1x, i);
+
+            pn = powers[i];
+            cond_neg_niels(&pn.n, inv);
+            constant_time_lookup(&tmp, buckets, sizeof(tmp), NTABLE, index);
+            add_pniels_to_pt(&tmp, &pn, 0);
+            constant_time_insert(buckets, &tmp, sizeof(tmp), NTABLE, index);
+        }
+
+        sum_odd_buckets(&scaled[k], buckets);
+    }
+
+    ristretto_bzero(&scalar1x,sizeof(scalar1x));
+    ristretto_bzero(&pn,sizeof(pn));
+    ristretto_bzero(powers,sizeof(powers));
+    ristretto_bzero(buckets,sizeof(buckets));
+    ristretto_bzero(&tmp,sizeof(tmp));
+}
+
+void ristretto255_point_scalarmul_multiples_non_secret (
+    point_t *scaled,
+    const point_t *base,
+    const scalar_t *scalars,
+    size_t n
+) {
+    const int WINDOW = RISTRETTO_WINDOW_BITS,
+        NTABLE = 1<<(WINDOW-1),
+        NWINDOWS = (SCALAR_BITS+WINDOW-1)/WINDOW;
+
+    /* The same buckets, but indexed directly, and filled without adding to
+     * the identity */
+    pniels_t powers[(SCALAR_BITS+RISTRETTO_WINDOW_BITS-1)/RISTRETTO_WINDOW_BITS]; // == NWINDOWS
+    point_t buckets[1<<((int)(RISTRETTO_WINDOW_BITS)-1)];
+    int used[1<<((int)(RISTRETTO_WINDOW_BITS)-1)];
+    scalar_t scalar1x;
+    int i;
+    size_t k;
+
+    prepare_window_powers(powers, base);
+
+    for (k=0; k<n; k++) {
+        ristretto255_scalar_add(&scalar1x, &scalars[k], &point_scalarmul_adjustment);
+        ristretto255_scalar_halve(&scalar1x,&scalar1x);
+
+        for (i=0; i<NTABLE; i++) used[i] = 0;
+
+        for (i=0; i<NWINDOWS; i++) {
+            mask_t inv;
+            word_t index = window_digit(&inv, &scalar1x, i);
+
+            if (!used[index]) {
+                pniels_to_pt(&buckets[index], &powers[i]);
+                if (inv) ristretto255_point_negate(&buckets[index], &buckets[index]);
+                used[index] = 1;
+            } else if (inv) {
+                sub_pniels_from_pt(&buckets[index], &powers[i], 0);
+            } else {
+                add_pniels_to_pt(&buckets[index], &powers[i], 0);
+            }
+        }
+
+        for (i=0; i<NTABLE; i++) {
+            if (!used[i]) ristretto255_point_copy(&buckets[i], &ristretto255_point_identity);
+        }
+        sum_odd_buckets(&scaled[k], buckets);
+    }
+
+    /* This function is non-secret, but whatever this is cheap. */
+    ristretto_bzero(&scalar1x,sizeof(scalar1x));
+    ristretto_bzero(buckets,sizeof(buckets));
+}
+
 ristretto_bool_t ristretto255_point_eq ( const point_t *p, const point_t *q ) {
     /* equality mod 2-torsion compares x/y */
     gf_25519_t a, b;
@@ -741,14 +1115,14 @@ void ristretto255_point_debugging_pscale (
 static void gf_batch_invert (
     gf_25519_t *__restrict__ out,
     const gf_25519_t *in,
-    unsigned int n
+    size_t n
 ) {
     gf_25519_t t1;
     assert(n>1);
 
     gf_copy(&out[1], &in[0]);
-    int i;
-    for (i=1; i<(int) (n-1); i++) {
+    size_t i;
+    for (i=1; i<n-1; i++) {
         gf_mul(&out[i+1], &out[i], &in[i]);
     }
     gf_mul(&out[0], &out[n-1], &in[n-1]);
@@ -763,35 +1137,310 @@ static void gf_batch_invert (
     }
 }
 
+static void normalize_niels (
+    niels_t *ni,
+    const gf_25519_t *zi
+) {
+    gf_25519_t product;
+
+    gf_mul(&product, &ni->a, zi);
+    gf_strong_reduce(&product);
+    gf_copy(&ni->a, &product);
+
+    gf_mul(&product, &ni->b, zi);
+    gf_strong_reduce(&product);
+    gf_copy(&ni->b, &product);
+
+    gf_mul(&product, &ni->c, zi);
+    gf_strong_reduce(&product);
+    gf_copy(&ni->c, &product);
+
+    ristretto_bzero(&product,sizeof(product));
+}
+
 static void batch_normalize_niels (
     niels_t *table,
     const gf_25519_t *zs,
     gf_25519_t *__restrict__ zis,
-    int n
+    size_t n
 ) {
-    int i;
-    gf_25519_t product;
+    size_t i;
+    gf_batch_invert(zis, zs, n);
+    for (i=0; i<n; i++) normalize_niels(&table[i], &zis[i]);
+}
+
+static void batch_normalize_comb (
+    niels_comb_t *table,
+    const gf_25519_t *zs,
+    gf_25519_t *__restrict__ zis,
+    size_t n
+) {
+    size_t i;
+    niels_t ni;
     gf_batch_invert(zis, zs, n);
 
     for (i=0; i<n; i++) {
-        gf_mul(&product, &table[i].a, &zis[i]);
-        gf_strong_reduce(&product);
-        gf_copy(&table[i].a, &product);
+        unpack_comb(&ni, &table[i]);
+        normalize_niels(&ni, &zis[i]);
+        pack_comb(&table[i], &ni);
+    }
+
+    ristretto_bzero(&ni,sizeof(ni));
+}
+
+/* The public cached points have the layouts of pniels_t and niels_t */
+void ristretto255_point_to_cached (
+    ristretto255_point_cached_t *cached,
+    const point_t *a
+) {
+    pt_to_pniels((pniels_t *)cached, a);
+}
+
+void ristretto255_point_add_cached (
+    point_t *sum,
+    const point_t *a,
+    const ristretto255_point_cached_t *b
+) {
+    if (sum != a) ristretto255_point_copy(sum, a);
+    add_pniels_to_pt(sum, (const pniels_t *)b, 0);
+}
 
-        gf_mul(&product, &table[i].b, &zis[i]);
-        gf_strong_reduce(&product);
-        gf_copy(&table[i].b, &product);
+void ristretto255_point_sub_cached (
+    point_t *diff,
+    const point_t *a,
+    const ristretto255_point_cached_t *b
+) {
+    if (diff != a) ristretto255_point_copy(diff, a);
+    sub_pniels_from_pt(diff, (const pniels_t *)b, 0);
+}
 
-        gf_mul(&product, &table[i].c, &zis[i]);
-        gf_strong_reduce(&product);
-        gf_copy(&table[i].c, &product);
+void ristretto255_point_cached_normalize (
+    ristretto255_point_affine_cached_t *out,
+    const ristretto255_point_cached_t *in,
+    size_t n
+) {
+    gf_25519_t zs[RISTRETTO255_CACHED_NORMALIZE_BATCH], zis[RISTRETTO255_CACHED_NORMALIZE_BATCH];
+    size_t i, j, m;
+
+    for (i=0; i<n; i+=m) {
+        m = n-i < RISTRETTO255_CACHED_NORMALIZE_BATCH ? n-i : RISTRETTO255_CACHED_NORMALIZE_BATCH;
+        for (j=0; j<m; j++) {
+            const pniels_t *pn = (const pniels_t *)&in[i+j];
+            memcpy(&out[i+j], &pn->n, sizeof(pn->n));
+            gf_copy(&zs[j], &pn->z);
+        }
+        if (m > 1) {
+            batch_normalize_niels((niels_t *)&out[i], zs, zis, m);
+        } else {
+            gf_invert(&zis[0], &zs[0], 1);
+            normalize_niels((niels_t *)&out[i], &zis[0]);
+        }
     }
 
-    ristretto_bzero(&product,sizeof(product));
+    ristretto_bzero(zs,sizeof(zs));
+    ristretto_bzero(zis,sizeof(zis));
 }
 
-void ristretto255_precompute (
+void ristretto255_point_add_affine_cached (
+    point_t *sum,
+    const point_t *a,
+    const ristretto255_point_affine_cached_t *b
+) {
+    if (sum != a) ristretto255_point_copy(sum, a);
+    add_niels_to_pt(sum, (const niels_t *)b, 0);
+}
+
+void ristretto255_point_sub_affine_cached (
+    point_t *diff,
+    const point_t *a,
+    const ristretto255_point_affine_cached_t *b
+) {
+    if (diff != a) ristretto255_point_copy(diff, a);
+    sub_niels_from_pt(diff, (const niels_t *)b, 0);
+}
+
+/* Sums.  Point i goes into lane i%RISTRETTO_SUM_LANES, so consecutive
+ * additions are independent, and the lanes are summed pairwise at the end.
+ */
+#define SUM_LANES RISTRETTO_SUM_LANES
+
+/* Decodings per pass of the batch inverse square root */
+#define SUM_ISR_BATCH 8
+
+/* Points a thread must have to be worth starting */
+#define SUM_MIN_PER_THREAD 256
+
+typedef struct {
+    point_t sum;
+    const point_t *points;     /* or NULL to decode ser */
+    const unsigned char *ser;
+    size_t n;
+    ristretto_bool_t allow_identity;
+    mask_t succ;
+} sum_job_t;
+
+static void sum_lanes (
+    point_t *sum,
+    point_t lanes[SUM_LANES]
+) {
+    unsigned int j, w;
+    for (w=1; w<SUM_LANES; w*=2) {
+        for (j=0; j+w<SUM_LANES; j+=2*w) {
+            ristretto255_point_add(&lanes[j], &lanes[j], &lanes[j+w]);
+        }
+    }
+    ristretto255_point_copy(sum, &lanes[0]);
+}
+
+static void point_sum_serial (sum_job_t *job) {
+    point_t lanes[SUM_LANES];
+    size_t i;
+
+    for (i=0; i<SUM_LANES; i++) {
+        ristretto255_point_copy(&lanes[i], i<job->n ? &job->points[i] : &ristretto255_point_identity);
+    }
+    for (; i<job->n; i++) {
+        ristretto255_point_add(&lanes[i%SUM_LANES], &lanes[i%SUM_LANES], &job->points[i]);
+    }
+    sum_lanes(&job->sum, lanes);
+    job->succ = -(mask_t)1;
+
+    ristretto_bzero(lanes,sizeof(lanes));
+}
+
+/* Decoded points have z=1, so they are added as pniels with z=2, which
+ * only doubles the lane's z */
+static void point_decode_sum_serial (sum_job_t *job) {
+    point_t lanes[SUM_LANES], p, *lane;
+    niels_t ni;
+    decode_state_t st[SUM_ISR_BATCH];
+    gf_25519_t isr[SUM_ISR_BATCH], isr_input[SUM_ISR_BATCH];
+    mask_t square[SUM_ISR_BATCH], all = -(mask_t)1;
+    size_t i;
+    unsigned int j, m;
+
+    for (j=0; j<SUM_LANES; j++) ristretto255_point_copy(&lanes[j], &ristretto255_point_identity);
+
+    for (i=0; i<job->n; i+=m) {
+        m = (job->n-i < SUM_ISR_BATCH) ? job->n-i : SUM_ISR_BATCH;
+        for (j=0; j<m; j++) {
+            point_decode_prepare(&st[j],&isr_input[j],&job->ser[SER_BYTES*(i+j)],job->allow_identity);
+        }
+        gf_isr_batch(isr,square,isr_input,m);
+        for (j=0; j<m; j++) {
+            mask_t succ = point_decode_finish(&p,&st[j],&isr[j],square[j]);
+            constant_time_select(&p,&ristretto255_point_identity,&p,sizeof(p),succ,0);
+            all &= succ;
+
+            gf_sub ( &ni.a, &p.y, &p.x );
+            gf_add ( &ni.b, &p.x, &p.y );
+            gf_mulw ( &ni.c, &p.t, 2*TWISTED_D );
+            lane = &lanes[(i+j)%SUM_LANES];
+            gf_add ( &lane->z, &lane->z, &lane->z );
+            add_niels_to_pt(lane, &ni, 0);
+        }
+    }
+    sum_lanes(&job->sum, lanes);
+    job->succ = all;
+
+    ristretto_bzero(lanes,sizeof(lanes));
+    ristretto_bzero(&p,sizeof(p));
+    ristretto_bzero(&ni,sizeof(ni));
+    ristretto_bzero(st,sizeof(st));
+    ristretto_bzero(isr,sizeof(isr));
+    ristretto_bzero(isr_input,sizeof(isr_input));
+}
+
+static void *point_sum_worker (void *arg) {
+    sum_job_t *job = (sum_job_t *)arg;
+    if (job->points) point_sum_serial(job);
+    else point_decode_sum_serial(job);
+    return NULL;
+}
+
+/* Split the job's n points across threads and sum their sums */
+static mask_t point_sum_threaded (
+    point_t *sum,
+    const sum_job_t *whole,
+    unsigned int threads
+) {
+    pthread_t tid[RISTRETTO_SUM_MAX_THREADS];
+    int started[RISTRETTO_SUM_MAX_THREADS];
+    sum_job_t jobs[RISTRETTO_SUM_MAX_THREADS];
+    size_t per, done = 0, n = whole->n;
+    mask_t succ = -(mask_t)1;
+    unsigned int i;
+
+    if (threads > RISTRETTO_SUM_MAX_THREADS) threads = RISTRETTO_SUM_MAX_THREADS;
+    if (threads > n / SUM_MIN_PER_THREAD) threads = (unsigned int)(n / SUM_MIN_PER_THREAD);
+    if (threads <= 1) {
+        jobs[0] = *whole;
+        point_sum_worker(&jobs[0]);
+        ristretto255_point_copy(sum, &jobs[0].sum);
+        succ = jobs[0].succ;
+        ristretto_bzero(&jobs[0],sizeof(jobs[0]));
+        return succ;
+    }
+    per = (n + threads - 1) / threads;
+
+    for (i=0; i<threads && done<n; i++) {
+        jobs[i] = *whole;
+        if (whole->points) jobs[i].points = &whole->points[done];
+        else jobs[i].ser = &whole->ser[SER_BYTES*done];
+        jobs[i].n = n-done < per ? n-done : per;
+        done += jobs[i].n;
+
+        /* The calling thread takes the last share, and any that fail to spawn */
+        started[i] = (done < n) && !pthread_create(&tid[i], NULL, point_sum_worker, &jobs[i]);
+        if (!started[i]) point_sum_worker(&jobs[i]);
+    }
+
+    ristretto255_point_copy(sum, &ristretto255_point_identity);
+    while (i--) {
+        if (started[i]) pthread_join(tid[i], NULL);
+        ristretto255_point_add(sum, sum, &jobs[i].sum);
+        succ &= jobs[i].succ;
+    }
+
+    ristretto_bzero(jobs,sizeof(jobs));
+    return succ;
+}
+
+void ristretto255_point_sum (
+    point_t *sum,
+    const point_t *points,
+    size_t n,
+    unsigned int threads
+) {
+    sum_job_t whole;
+    memset(&whole, 0, sizeof(whole));
+    whole.points = points;
+    whole.n = n;
+    (void)point_sum_threaded(sum, &whole, threads);
+}
+
+ristretto_error_t ristretto255_point_decode_sum (
+    point_t *sum,
+    const unsigned char *ser,
+    size_t n,
+    ristretto_bool_t allow_identity,
+    unsigned int threads
+) {
+    sum_job_t whole;
+    mask_t succ;
+    memset(&whole, 0, sizeof(whole));
+    whole.ser = ser;
+    whole.n = n;
+    whole.allow_identity = allow_identity;
+    succ = point_sum_threaded(sum, &whole, threads);
+    constant_time_select(sum,&ristretto255_point_identity,sum,sizeof(*sum),succ,0);
+    return ristretto_succeed_if(mask_to_bool(succ));
+}
+
+/* Comb tables for base, leaving entry i over the denominator zs[i] */
+static void precompute_projective (
     precomputed_s *table,
+    gf_25519_t *zs,
     const point_t *base
 ) {
     const unsigned int n = COMBS_N, t = COMBS_T, s = COMBS_S;
@@ -801,8 +1450,6 @@ void ristretto255_precompute (
     ristretto255_point_copy(&working, base);
     pniels_t pn_tmp;
 
-    gf_25519_t zs[(unsigned int)(COMBS_N)<<(unsigned int)(COMBS_T-1)], zis[(unsigned int)(COMBS_N)<<(unsigned int)(COMBS_T-1)];
-
     unsigned int i,j,k;
 
     /* Compute n tables */
@@ -828,7 +1475,7 @@ void ristretto255_precompute (
             int idx = (((i+1)<<(t-1))-1) ^ gray;
 
             pt_to_pniels(&pn_tmp, &start);
-            memcpy(&table->table[idx], &pn_tmp.n, sizeof(pn_tmp.n));
+            pack_comb(&table->table[idx], &pn_tmp.n);
             gf_copy(&zs[idx], &pn_tmp.z);
 
             if (j >= (1u<<(t-1)) - 1) break;
@@ -845,24 +1492,122 @@ void ristretto255_precompute (
         }
     }
 
-    batch_normalize_niels(table->table,zs,zis,n<<(t-1));
-
-    ristretto_bzero(&zs,sizeof(zs));
-    ristretto_bzero(&zis,sizeof(zis));
     ristretto_bzero(&pn_tmp,sizeof(pn_tmp));
     ristretto_bzero(&working,sizeof(working));
     ristretto_bzero(&start,sizeof(start));
     ristretto_bzero(&doubles,sizeof(doubles));
 }
 
+void ristretto255_precompute (
+    precomputed_s *table,
+    const point_t *base
+) {
+    gf_25519_t zs[COMBS_ENTRIES], zis[COMBS_ENTRIES];
+    precompute_projective(table, zs, base);
+    batch_normalize_comb(table->table,zs,zis,COMBS_ENTRIES);
+    ristretto_bzero(&zs,sizeof(zs));
+    ristretto_bzero(&zis,sizeof(zis));
+}
+
+/* Tables for bases [0,n), one inversion per RISTRETTO_PRECOMPUTE_BATCH */
+static void precompute_batch_serial (
+    precomputed_s *tables,
+    const point_t *bases,
+    size_t n
+) {
+    gf_25519_t zs[RISTRETTO_PRECOMPUTE_BATCH*COMBS_ENTRIES], zis[RISTRETTO_PRECOMPUTE_BATCH*COMBS_ENTRIES];
+    size_t i, j;
+
+    for (i=0; i<n; i+=RISTRETTO_PRECOMPUTE_BATCH) {
+        size_t m = n-i < RISTRETTO_PRECOMPUTE_BATCH ? n-i : RISTRETTO_PRECOMPUTE_BATCH;
+        for (j=0; j<m; j++) precompute_projective(&tables[i+j], &zs[j*COMBS_ENTRIES], &bases[i+j]);
+
+        /* The tables are contiguous, so their entries form one array */
+        batch_normalize_comb(tables[i].table, zs, zis, m*COMBS_ENTRIES);
+    }
+
+    ristretto_bzero(&zs,sizeof(zs));
+    ristretto_bzero(&zis,sizeof(zis));
+}
+
+void ristretto255_precompute_batch_ws (
+    precomputed_s *tables,
+    const point_t *bases,
+    size_t n,
+    void *workspace
+) {
+    gf_25519_t *zs = (gf_25519_t *)workspace, *zis = &zs[n*COMBS_ENTRIES];
+    size_t i;
+
+    for (i=0; i<n; i++) precompute_projective(&tables[i], &zs[i*COMBS_ENTRIES], &bases[i]);
+    if (n) batch_normalize_comb(tables->table, zs, zis, n*COMBS_ENTRIES);
+
+    ristretto_bzero(workspace, ristretto255_workspace_size(RISTRETTO255_WS_PRECOMPUTE_BATCH, n));
+}
+
+typedef struct {
+    precomputed_s *tables;
+    const point_t *bases;
+    size_t n;
+} precompute_job_t;
+
+static void *precompute_batch_worker (void *arg) {
+    const precompute_job_t *job = (const precompute_job_t *)arg;
+    precompute_batch_serial(job->tables, job->bases, job->n);
+    return NULL;
+}
+
+void ristretto255_precompute_batch (
+    precomputed_s *tables,
+    const point_t *bases,
+    size_t n,
+    unsigned int threads
+) {
+    pthread_t tid[RISTRETTO_PRECOMPUTE_MAX_THREADS];
+    int started[RISTRETTO_PRECOMPUTE_MAX_THREADS];
+    precompute_job_t jobs[RISTRETTO_PRECOMPUTE_MAX_THREADS];
+    size_t per, done = 0;
+    unsigned int i;
+
+    /* Give each thread whole inversion batches */
+    size_t batches = (n + RISTRETTO_PRECOMPUTE_BATCH - 1) / RISTRETTO_PRECOMPUTE_BATCH;
+    if (threads > RISTRETTO_PRECOMPUTE_MAX_THREADS) threads = RISTRETTO_PRECOMPUTE_MAX_THREADS;
+    if (threads > batches) threads = (unsigned int)batches;
+    if (threads <= 1) {
+        precompute_batch_serial(tables, bases, n);
+        return;
+    }
+    per = (batches + threads - 1) / threads * RISTRETTO_PRECOMPUTE_BATCH;
+
+    for (i=0; i<threads && done<n; i++) {
+        jobs[i].tables = &tables[done];
+        jobs[i].bases = &bases[done];
+        jobs[i].n = n-done < per ? n-done : per;
+        done += jobs[i].n;
+
+        /* The calling thread takes the last share, and any that fail to spawn */
+        started[i] = (done < n) && !pthread_create(&tid[i], NULL, precompute_batch_worker, &jobs[i]);
+        if (!started[i]) precompute_batch_worker(&jobs[i]);
+    }
+
+    while (i--) {
+        if (started[i]) pthread_join(tid[i], NULL);
+    }
+}
+
+/* ni = table[idx] in constant time.  The entry passes through packed,
+ * which the caller clears along with ni.
+ */
 static RISTRETTO_INLINE void
 constant_time_lookup_niels (
     niels_t *__restrict__ ni,
-    const niels_t *table,
+    niels_comb_t *__restrict__ packed,
+    const niels_comb_t *table,
     int nelts,
     int idx
 ) {
-    constant_time_lookup(ni, table, sizeof(niels_t), nelts, idx);
+    constant_time_lookup_aligned(packed, table, sizeof(*packed), nelts, idx);
+    unpack_comb(ni, packed);
 }
 
 void ristretto255_precomputed_scalarmul (
@@ -879,6 +1624,7 @@ void ristretto255_precomputed_scalarmul (
     ristretto255_scalar_halve(&scalar1x,&scalar1x);
 
     niels_t ni;
+    niels_comb_t packed;
 
     for (i=s-1; i>=0; i--) {
         if (i != (int)s-1) point_double_internal(out,out,0);
@@ -897,7 +1643,7 @@ void ristretto255_precomputed_scalarmul (
             tab ^= invert;
             tab &= (1<<(t-1)) - 1;
 
-            constant_time_lookup_niels(&ni, &table->table[j<<(t-1)], 1<<(t-1), tab);
+            constant_time_lookup_niels(&ni, &packed, &table->table[j<<(t-1)], 1<<(t-1), tab);
 
             cond_neg_niels(&ni, invert);
             if ((i!=(int)s-1)||j) {
@@ -909,9 +1655,57 @@ void ristretto255_precomputed_scalarmul (
     }
 
     ristretto_bzero(&ni,sizeof(ni));
+    ristretto_bzero(&packed,sizeof(packed));
     ristretto_bzero(&scalar1x,sizeof(scalar1x));
 }
 
+void ristretto255_base_scalarmul_non_secret (
+    point_t *out,
+    const scalar_t *scalar
+) {
+    /* The comb of precomputed_scalarmul, indexed directly */
+    const niels_comb_t *table = ristretto255_precomputed_base->table;
+    niels_t ni;
+    int i;
+    unsigned j,k;
+    const unsigned int n = COMBS_N, t = COMBS_T, s = COMBS_S;
+
+    scalar_t scalar1x;
+    ristretto255_scalar_add(&scalar1x, scalar, &precomputed_scalarmul_adjustment);
+    ristretto255_scalar_halve(&scalar1x,&scalar1x);
+
+    for (i=s-1; i>=0; i--) {
+        if (i != (int)s-1) point_double_internal(out,out,0);
+
+        for (j=0; j<n; j++) {
+            int tab = 0;
+
+            for (k=0; k<t; k++) {
+                unsigned int bit = i + s*(k + j*t);
+                if (bit < SCALAR_BITS) {
+                    tab |= (scalar1x.limb[bit/WBITS] >> (bit%WBITS) & 1) << k;
+                }
+            }
+
+            int invert = !(tab>>(t-1));
+            if (invert) tab = ~tab;
+            tab &= (1<<(t-1)) - 1;
+
+            unpack_comb(&ni, &table[(j<<(t-1)) + tab]);
+            if ((i!=(int)s-1)||j) {
+                if (invert) {
+                    sub_niels_from_pt(out, &ni, j==n-1 && i);
+                } else {
+                    add_niels_to_pt(out, &ni, j==n-1 && i);
+                }
+            } else {
+                niels_to_pt(out, &ni);
+                if (invert) ristretto255_point_negate(out, out);
+            }
+        }
+    }
+}
+
 void ristretto255_point_cond_sel (
     point_t *out,
     const point_t *a,
@@ -939,6 +1733,336 @@ ristretto_error_t ristretto255_direct_scalarmul (
     return succ;
 }
 
+ristretto_error_t ristretto255_direct_scalarmul_fanout (
+    uint8_t *scaled,
+    ristretto_bool_t *success,
+    const uint8_t *bases,
+    const scalar_t *scalar,
+    size_t n,
+    ristretto_bool_t allow_identity
+) {
+    const int WINDOW = RISTRETTO_WINDOW_BITS,
+        WINDOW_MASK = (1<<WINDOW)-1,
+        WINDOW_T_MASK = WINDOW_MASK >> 1,
+        NTABLE = 1<<(WINDOW-1),
+        NWINDOWS = (SCALAR_BITS+WINDOW-1)/WINDOW;
+
+    /* Recode the scalar once, into table indices and negation masks */
+    scalar_t scalar1x;
+    word_t digits[(SCALAR_BITS+RISTRETTO_WINDOW_BITS-1)/RISTRETTO_WINDOW_BITS]; // == NWINDOWS
+    mask_t invs[(SCALAR_BITS+RISTRETTO_WINDOW_BITS-1)/RISTRETTO_WINDOW_BITS];
+    int i, w;
+    ristretto255_scalar_add(&scalar1x, scalar, &point_scalarmul_adjustment);
+    ristretto255_scalar_halve(&scalar1x,&scalar1x);
+    for (i = SCALAR_BITS - ((SCALAR_BITS-1) % WINDOW) - 1, w=0; i>=0; i-=WINDOW, w++) {
+        word_t bits = scalar1x.limb[i/WBITS] >> (i%WBITS);
+        if (i%WBITS >= WBITS-WINDOW && i/WBITS<SCALAR_LIMBS-1) {
+            bits ^= scalar1x.limb[i/WBITS+1] << (WBITS - (i%WBITS));
+        }
+        bits &= WINDOW_MASK;
+        invs[w] = (bits>>(WINDOW-1))-1;
+        digits[w] = (bits ^ invs[w]) & WINDOW_T_MASK;
+    }
+
+    pniels_t pn;
+    pniels_packed_t packed, multiples[RISTRETTO_FANOUT_BATCH][1<<((int)(RISTRETTO_WINDOW_BITS)-1)];
+    point_t pts[RISTRETTO_FANOUT_BATCH];
+    decode_state_t st[RISTRETTO_FANOUT_BATCH];
+    gf_25519_t isr[RISTRETTO_FANOUT_BATCH], isr_input[RISTRETTO_FANOUT_BATCH], s, ie1, ie2;
+    gf_25519_t num[RISTRETTO_FANOUT_BATCH], den[RISTRETTO_FANOUT_BATCH];
+    mask_t square[RISTRETTO_FANOUT_BATCH], all = -(mask_t)1;
+    size_t k;
+    unsigned int j, m;
+
+    for (k=0; k<n; k+=m) {
+        m = (n-k < RISTRETTO_FANOUT_BATCH) ? n-k : RISTRETTO_FANOUT_BATCH;
+
+        /* Decode, replacing failures with the base point */
+        for (j=0; j<m; j++) {
+            point_decode_prepare(&st[j],&isr_input[j],&bases[SER_BYTES*(k+j)],allow_identity);
+        }
+        gf_isr_batch(isr,square,isr_input,m);
+        for (j=0; j<m; j++) {
+            mask_t succ = point_decode_finish(&pts[j],&st[j],&isr[j],square[j]);
+            constant_time_select(&pts[j],&ristretto255_point_base,&pts[j],sizeof(pts[j]),succ,0);
+            prepare_fixed_window(multiples[j], &pts[j], NTABLE);
+            success[k+j] = mask_to_bool(succ);
+            all &= succ;
+        }
+
+        /* Run the bases' windows in lockstep */
+        for (w=0; w<NWINDOWS; w++) {
+            for (j=0; j<m; j++) {
+                constant_time_lookup_pniels(&pn, &packed, multiples[j], NTABLE, digits[w]);
+                cond_neg_niels(&pn.n, invs[w]);
+                if (w == 0) {
+                    pniels_to_pt(&pts[j], &pn);
+                } else {
+                    for (i=0; i<WINDOW-1; i++)
+                        point_double_internal(&pts[j], &pts[j], -1);
+                    point_double_internal(&pts[j], &pts[j], 0);
+                    add_pniels_to_pt(&pts[j], &pn, w<NWINDOWS-1 ? -1 : 0);
+                }
+            }
+        }
+
+        /* Encode */
+        for (j=0; j<m; j++) ristretto255_deisogenize_isr_input(&isr_input[j],&num[j],&den[j],&pts[j]);
+        gf_isr_batch(isr,square,isr_input,m);
+        for (j=0; j<m; j++) {
+            ristretto255_deisogenize_finish(&s,&ie1,&ie2,&pts[j],&num[j],&den[j],&isr[j],0,0,0);
+            gf_serialize(&scaled[SER_BYTES*(k+j)],&s,1);
+        }
+    }
+
+    ristretto_bzero(&scalar1x,sizeof(scalar1x));
+    ristretto_bzero(digits,sizeof(digits));
+    ristretto_bzero(invs,sizeof(invs));
+    ristretto_bzero(&pn,sizeof(pn));
+    ristretto_bzero(&packed,sizeof(packed));
+    ristretto_bzero(multiples,sizeof(multiples));
+    ristretto_bzero(pts,sizeof(pts));
+    ristretto_bzero(st,sizeof(st));
+    ristretto_bzero(isr,sizeof(isr));
+    ristretto_bzero(isr_input,sizeof(isr_input));
+    ristretto_bzero(num,sizeof(num));
+    ristretto_bzero(den,sizeof(den));
+    return ristretto_succeed_if(mask_to_bool(all));
+}
+
+/* Point blocks.  With a vector unit, add and double run on all four lanes
+ * at once; otherwise each lane goes through the scalar formulas.  Encode
+ * and decode share their inverse square roots, like the fanout above.
+ */
+#define point_block_t ristretto255_point_block_t
+#define BLOCK_LANES RISTRETTO255_POINT_BLOCK_LANES
+
+/* Points per pass of the batch inverse: one block of gf_isr_batch */
+#define BLOCK_ISR_BATCH 8
+
+static void point_block_get (point_t *p, const point_block_t *b, unsigned int j) {
+    unsigned int i;
+    for (i=0; i<RISTRETTO255_FIELD_LIMBS; i++) {
+        p->x.limb[i] = b->x[i][j];
+        p->y.limb[i] = b->y[i][j];
+        p->z.limb[i] = b->z[i][j];
+        p->t.limb[i] = b->t[i][j];
+    }
+}
+
+/* Lanes are kept weakly reduced, which the vector loads rely on */
+static void point_block_set (point_block_t *b, unsigned int j, const point_t *p) {
+    point_t r = *p;
+    unsigned int i;
+    gf_weak_reduce(&r.x);
+    gf_weak_reduce(&r.y);
+    gf_weak_reduce(&r.z);
+    gf_weak_reduce(&r.t);
+    for (i=0; i<RISTRETTO255_FIELD_LIMBS; i++) {
+        b->x[i][j] = r.x.limb[i];
+        b->y[i][j] = r.y.limb[i];
+        b->z[i][j] = r.z.limb[i];
+        b->t[i][j] = r.t.limb[i];
+    }
+}
+
+#if __AVX2__
+typedef struct { gf4_25519_t x, y, z, t; } point4_t;
+
+static void point4_load (point4_t *p, const point_block_t *b) {
+    gf4_load_lanes(&p->x, b->x);
+    gf4_load_lanes(&p->y, b->y);
+    gf4_load_lanes(&p->z, b->z);
+    gf4_load_lanes(&p->t, b->t);
+}
+
+static void point4_store (point_block_t *b, const point4_t *p) {
+    gf4_store_lanes(b->x, &p->x);
+    gf4_store_lanes(b->y, &p->y);
+    gf4_store_lanes(b->z, &p->z);
+    gf4_store_lanes(b->t, &p->t);
+}
+
+/* As ristretto255_point_add, lanewise */
+static void point4_add (point4_t *__restrict__ p, const point4_t *q, const point4_t *r) {
+    gf4_25519_t a, b, c, d, e;
+    gf4_sub ( &a, &q->y, &q->x );
+    gf4_sub ( &b, &r->y, &r->x );
+    gf4_mul ( &c, &a, &b );
+    gf4_add ( &a, &q->y, &q->x );
+    gf4_add ( &b, &r->y, &r->x );
+    gf4_mul ( &d, &a, &b );
+    gf4_mul ( &a, &q->t, &r->t );
+    gf4_mulw ( &e, &a, 2*TWISTED_D );
+    gf4_mul ( &a, &q->z, &r->z );
+    gf4_add ( &a, &a, &a );
+    gf4_sub ( &b, &d, &c );
+    gf4_add ( &d, &d, &c );
+    gf4_sub ( &c, &a, &e );
+    gf4_add ( &a, &a, &e );
+    gf4_mul ( &p->x, &b, &c );
+    gf4_mul ( &p->y, &a, &d );
+    gf4_mul ( &p->z, &c, &a );
+    gf4_mul ( &p->t, &b, &d );
+}
+
+/* As ristretto255_point_double, lanewise */
+static void point4_double (point4_t *__restrict__ p, const point4_t *q) {
+    gf4_25519_t a, b, c, d, e;
+    gf4_sqr ( &c, &q->x );
+    gf4_sqr ( &a, &q->y );
+    gf4_add ( &d, &c, &a );
+    gf4_add ( &e, &q->y, &q->x );
+    gf4_sqr ( &b, &e );
+    gf4_sub ( &b, &b, &d );
+    gf4_sub ( &e, &a, &c );
+    gf4_sqr ( &a, &q->z );
+    gf4_add ( &a, &a, &a );
+    gf4_sub ( &a, &a, &e );
+    gf4_mul ( &p->x, &a, &b );
+    gf4_mul ( &p->z, &e, &a );
+    gf4_mul ( &p->y, &e, &d );
+    gf4_mul ( &p->t, &b, &d );
+}
+#endif /* __AVX2__ */
+
+void ristretto255_point_block_load (
+    point_block_t *blocks,
+    const point_t *points,
+    size_t n
+) {
+    size_t i;
+    for (i=0; i<RISTRETTO255_POINT_BLOCKS(n)*BLOCK_LANES; i++) {
+        point_block_set(&blocks[i/BLOCK_LANES], i%BLOCK_LANES,
+            (i<n) ? &points[i] : &ristretto255_point_identity);
+    }
+}
+
+void ristretto255_point_block_store (
+    point_t *points,
+    const point_block_t *blocks,
+    size_t n
+) {
+    size_t i;
+    for (i=0; i<n; i++) point_block_get(&points[i], &blocks[i/BLOCK_LANES], i%BLOCK_LANES);
+}
+
+void ristretto255_point_block_add (
+    point_block_t *sum,
+    const point_block_t *a,
+    const point_block_t *b,
+    size_t n
+) {
+    size_t k;
+    for (k=0; k<RISTRETTO255_POINT_BLOCKS(n); k++) {
+#if __AVX2__
+        point4_t p, q, r;
+        RISTRETTO_COUNT(point_add, BLOCK_LANES);
+        point4_load(&q, &a[k]);
+        point4_load(&r, &b[k]);
+        point4_add(&p, &q, &r);
+        point4_store(&sum[k], &p);
+#else
+        point_t p, q;
+        unsigned int j;
+        for (j=0; j<BLOCK_LANES; j++) {
+            point_block_get(&p, &a[k], j);
+            point_block_get(&q, &b[k], j);
+            ristretto255_point_add(&p, &p, &q);
+            point_block_set(&sum[k], j, &p);
+        }
+#endif
+    }
+}
+
+void ristretto255_point_block_double (
+    point_block_t *two_a,
+    const point_block_t *a,
+    size_t n
+) {
+    size_t k;
+    for (k=0; k<RISTRETTO255_POINT_BLOCKS(n); k++) {
+#if __AVX2__
+        point4_t p, q;
+        RISTRETTO_COUNT(point_double, BLOCK_LANES);
+        point4_load(&q, &a[k]);
+        point4_double(&p, &q);
+        point4_store(&two_a[k], &p);
+#else
+        point_t p;
+        unsigned int j;
+        for (j=0; j<BLOCK_LANES; j++) {
+            point_block_get(&p, &a[k], j);
+            point_double_internal(&p, &p, 0);
+            point_block_set(&two_a[k], j, &p);
+        }
+#endif
+    }
+}
+
+void ristretto255_point_block_encode (
+    uint8_t *ser,
+    const point_block_t *blocks,
+    size_t n
+) {
+    point_t pts[BLOCK_ISR_BATCH];
+    gf_25519_t isr[BLOCK_ISR_BATCH], isr_input[BLOCK_ISR_BATCH], s, ie1, ie2;
+    gf_25519_t num[BLOCK_ISR_BATCH], den[BLOCK_ISR_BATCH];
+    mask_t square[BLOCK_ISR_BATCH];
+    size_t i;
+    unsigned int j, m;
+
+    for (i=0; i<n; i+=m) {
+        m = (n-i < BLOCK_ISR_BATCH) ? n-i : BLOCK_ISR_BATCH;
+        for (j=0; j<m; j++) {
+            point_block_get(&pts[j], &blocks[(i+j)/BLOCK_LANES], (i+j)%BLOCK_LANES);
+            ristretto255_deisogenize_isr_input(&isr_input[j],&num[j],&den[j],&pts[j]);
+        }
+        gf_isr_batch(isr,square,isr_input,m);
+        for (j=0; j<m; j++) {
+            ristretto255_deisogenize_finish(&s,&ie1,&ie2,&pts[j],&num[j],&den[j],&isr[j],0,0,0);
+            gf_serialize(&ser[SER_BYTES*(i+j)],&s,1);
+        }
+    }
+}
+
+ristretto_error_t ristretto255_point_block_decode (
+    point_block_t *blocks,
+    ristretto_bool_t *success,
+    const uint8_t *ser,
+    size_t n,
+    ristretto_bool_t allow_identity
+) {
+    decode_state_t st[BLOCK_ISR_BATCH];
+    gf_25519_t isr[BLOCK_ISR_BATCH], isr_input[BLOCK_ISR_BATCH];
+    mask_t square[BLOCK_ISR_BATCH], all = -(mask_t)1;
+    point_t p;
+    size_t i;
+    unsigned int j, m;
+
+    for (i=0; i<n; i+=m) {
+        m = (n-i < BLOCK_ISR_BATCH) ? n-i : BLOCK_ISR_BATCH;
+        for (j=0; j<m; j++) {
+            point_decode_prepare(&st[j],&isr_input[j],&ser[SER_BYTES*(i+j)],allow_identity);
+        }
+        gf_isr_batch(isr,square,isr_input,m);
+        for (j=0; j<m; j++) {
+            mask_t succ = point_decode_finish(&p,&st[j],&isr[j],square[j]);
+            constant_time_select(&p,&ristretto255_point_identity,&p,sizeof(p),succ,0);
+            point_block_set(&blocks[(i+j)/BLOCK_LANES], (i+j)%BLOCK_LANES, &p);
+            success[i+j] = mask_to_bool(succ);
+            all &= succ;
+        }
+    }
+    for (; i<RISTRETTO255_POINT_BLOCKS(n)*BLOCK_LANES; i++) {
+        point_block_set(&blocks[i/BLOCK_LANES], i%BLOCK_LANES, &ristretto255_point_identity);
+    }
+
+    ristretto_bzero(st,sizeof(st));
+    ristretto_bzero(&p,sizeof(p));
+    return ristretto_succeed_if(mask_to_bool(all));
+}
+
 /**
  * @cond internal
  * Control for variable-time scalar multiply algorithms.
@@ -1073,26 +2197,26 @@ void ristretto255_precompute_wnafs (
     ristretto_bzero(zis,sizeof(zis));
 }
 
-void ristretto255_base_double_scalarmul_non_secret (
+/* scalar1*base + scalar2*base2, given base2's odd multiples up to table_bits_var */
+static void
+base_double_wnaf (
     point_t *combo,
     const scalar_t *scalar1,
-    const point_t *base2,
+    const pniels_t *precmp_var,
+    int table_bits_var,
     const scalar_t *scalar2
 ) {
-    const int table_bits_var = RISTRETTO_WNAF_VAR_TABLE_BITS,
-        table_bits_pre = RISTRETTO_WNAF_FIXED_TABLE_BITS;
+    const int table_bits_pre = RISTRETTO_WNAF_FIXED_TABLE_BITS;
     struct smvt_control control_var[SCALAR_BITS/((int)(RISTRETTO_WNAF_VAR_TABLE_BITS)+1)+3];
     struct smvt_control control_pre[SCALAR_BITS/((int)(RISTRETTO_WNAF_FIXED_TABLE_BITS)+1)+3];
+    assert(table_bits_var >= RISTRETTO_WNAF_VAR_TABLE_BITS);
 
     int ncb_pre = recode_wnaf(control_pre, scalar1, table_bits_pre);
     int ncb_var = recode_wnaf(control_var, scalar2, table_bits_var);
 
-    pniels_t precmp_var[1<<(int)(RISTRETTO_WNAF_VAR_TABLE_BITS)];
-    prepare_wnaf_table(precmp_var, base2, table_bits_var);
-
     int contp=0, contv=0, i = control_var[0].power;
 
-    if (i < 0) {
+    if (i < 0 && control_pre[0].power < 0) {
         ristretto255_point_copy(combo, &ristretto255_point_identity);
         return;
     } else if (i > control_pre[0].power) {
@@ -1138,12 +2262,99 @@ void ristretto255_base_double_scalarmul_non_secret (
     /* This function is non-secret, but whatever this is cheap. */
     ristretto_bzero(&control_var,sizeof(control_var));
     ristretto_bzero(&control_pre,sizeof(control_pre));
-    ristretto_bzero(&precmp_var,sizeof(precmp_var));
 
     assert(contv == ncb_var); (void)ncb_var;
     assert(contp == ncb_pre); (void)ncb_pre;
 }
 
+void ristretto255_base_double_scalarmul_non_secret (
+    point_t *combo,
+    const scalar_t *scalar1,
+    const point_t *base2,
+    const scalar_t *scalar2
+) {
+    pniels_t precmp_var[1<<(int)(RISTRETTO_WNAF_VAR_TABLE_BITS)];
+    prepare_wnaf_table(precmp_var, base2, RISTRETTO_WNAF_VAR_TABLE_BITS);
+    base_double_wnaf(combo, scalar1, precmp_var, RISTRETTO_WNAF_VAR_TABLE_BITS, scalar2);
+    ristretto_bzero(&precmp_var,sizeof(precmp_var));
+}
+
+void ristretto255_precomputed_wnaf_base_double_scalarmul_non_secret (
+    point_t *combo,
+    const scalar_t *scalar1,
+    const precomputed_wnaf_s *base2,
+    const scalar_t *scalar2
+) {
+    base_double_wnaf(combo, scalar1, base2->table, RISTRETTO_WNAF_SINGLE_TABLE_BITS, scalar2);
+}
+
+/* Variable-time scalarmul against a table of odd multiples */
+static void
+wnaf_single_scalarmul (
+    point_t *scaled,
+    const pniels_t *precmp,
+    const scalar_t *scalar
+) {
+    const int table_bits = RISTRETTO_WNAF_SINGLE_TABLE_BITS;
+    struct smvt_control control[SCALAR_BITS/((int)(RISTRETTO_WNAF_SINGLE_TABLE_BITS)+1)+3];
+
+    int ncb = recode_wnaf(control, scalar, table_bits);
+    int contv=0, i = control[0].power;
+
+    if (i < 0) {
+        ristretto255_point_copy(scaled, &ristretto255_point_identity);
+        return;
+    }
+
+    pniels_to_pt(scaled, &precmp[control[0].addend >> 1]);
+    contv++;
+
+    for (i--; i >= 0; i--) {
+        int cv = (i==control[contv].power);
+        point_double_internal(scaled,scaled,i && !cv);
+
+        if (cv) {
+            assert(control[contv].addend);
+
+            if (control[contv].addend > 0) {
+                add_pniels_to_pt(scaled, &precmp[control[contv].addend >> 1], i);
+            } else {
+                sub_pniels_from_pt(scaled, &precmp[(-control[contv].addend) >> 1], i);
+            }
+            contv++;
+        }
+    }
+
+    assert(contv == ncb); (void)ncb;
+}
+
+void ristretto255_point_scalarmul_non_secret (
+    point_t *scaled,
+    const point_t *base,
+    const scalar_t *scalar
+) {
+    /* With only one table to build, it can be bigger than in the double
+     * scalarmul */
+    pniels_t precmp[1<<(int)(RISTRETTO_WNAF_SINGLE_TABLE_BITS)];
+    prepare_wnaf_table(precmp, base, RISTRETTO_WNAF_SINGLE_TABLE_BITS);
+    wnaf_single_scalarmul(scaled, precmp, scalar);
+}
+
+void ristretto255_precompute_wnaf (
+    precomputed_wnaf_s *table,
+    const point_t *base
+) {
+    prepare_wnaf_table(table->table, base, RISTRETTO_WNAF_SINGLE_TABLE_BITS);
+}
+
+void ristretto255_precomputed_wnaf_scalarmul_non_secret (
+    point_t *scaled,
+    const precomputed_wnaf_s *base,
+    const scalar_t *scalar
+) {
+    wnaf_single_scalarmul(scaled, base->table, scalar);
+}
+
 void ristretto255_point_destroy (
     point_t *point
 ) {
@@ -0,0 +1,104 @@
+/**
+ * @file ristretto_config.h
+ * @copyright
+ *   Copyright (c) 2015-2018 Ristretto Developers, Cryptography Research, Inc.  \n
+ *   Released under the MIT License.  See LICENSE.txt for license information.
+ * @author Mike Hamburg
+ * @brief Table and window sizes.
+ *
+ * Each may be overridden at build time, either with -D or with a header
+ * written by "make autotune" and passed as TUNED=file.  The fixed tables in
+ * ristretto_tables.c are generated by ristretto_gen_tables with the same
+ * settings, so changing them needs a make clean.
+ */
+
+#ifndef __RISTRETTO_CONFIG_H__
+#define __RISTRETTO_CONFIG_H__ 1
+
+#ifdef RISTRETTO_TUNED_CONFIG
+#include RISTRETTO_TUNED_CONFIG
+#endif
+
+/* Comb config for precomputed_scalarmul: number of combs, n, t, s. */
+#ifndef COMBS_N
+#define COMBS_N 3
+#endif
+#ifndef COMBS_T
+#define COMBS_T 5
+#endif
+#ifndef COMBS_S
+#define COMBS_S 17
+#endif
+
+/* Store comb entries as three canonical 32-byte coordinates, unpacked on
+ * lookup: 96 bytes rather than 128.  With AVX2 this pays once the tables in
+ * use stop fitting in cache, as in the precomputed_scalarmul_many benchmark.
+ * With AVX-512 the lookup reads as many registers either way, so it doesn't. */
+#ifndef RISTRETTO_COMPACT_COMBS
+#define RISTRETTO_COMPACT_COMBS 0
+#endif
+
+/* Signed window for the constant-time scalarmuls */
+#ifndef RISTRETTO_WINDOW_BITS
+#define RISTRETTO_WINDOW_BITS 4
+#endif
+
+/* wNAF tables: the base point's, a one-off table in double scalarmuls, and
+ * a table used for a single scalarmul or kept for reuse */
+#ifndef RISTRETTO_WNAF_FIXED_TABLE_BITS
+#define RISTRETTO_WNAF_FIXED_TABLE_BITS 5
+#endif
+#ifndef RISTRETTO_WNAF_VAR_TABLE_BITS
+#define RISTRETTO_WNAF_VAR_TABLE_BITS 3
+#endif
+#ifndef RISTRETTO_WNAF_SINGLE_TABLE_BITS
+#define RISTRETTO_WNAF_SINGLE_TABLE_BITS 4
+#endif
+
+/* Points per pass of the batched scalarmuls and precomputations */
+#ifndef RISTRETTO_FANOUT_BATCH
+#define RISTRETTO_FANOUT_BATCH 8
+#endif
+#ifndef RISTRETTO_PRECOMPUTE_BATCH
+#define RISTRETTO_PRECOMPUTE_BATCH 8
+#endif
+#ifndef RISTRETTO_PRECOMPUTE_MAX_THREADS
+#define RISTRETTO_PRECOMPUTE_MAX_THREADS 64
+#endif
+
+/* Independent accumulators in ristretto255_point_sum and _decode_sum, and
+ * the most threads they split the points across */
+#ifndef RISTRETTO_SUM_LANES
+#define RISTRETTO_SUM_LANES 4
+#endif
+#ifndef RISTRETTO_SUM_MAX_THREADS
+#define RISTRETTO_SUM_MAX_THREADS 64
+#endif
+
+#if COMBS_N < 1 || COMBS_T < 2 || COMBS_S < 1 || COMBS_N*COMBS_T*COMBS_S < RISTRETTO255_SCALAR_BITS
+#error "COMBS_N*COMBS_T*COMBS_S must cover the scalar, with COMBS_T >= 2"
+#endif
+#if COMBS_N*COMBS_T*COMBS_S > 512
+#error "the combs may cover at most 512 bits"
+#endif
+#if RISTRETTO_WINDOW_BITS < 2 || RISTRETTO_WINDOW_BITS > 8
+#error "RISTRETTO_WINDOW_BITS must be between 2 and 8"
+#endif
+#if RISTRETTO_WNAF_FIXED_TABLE_BITS < 1 || RISTRETTO_WNAF_FIXED_TABLE_BITS > 8 \
+    || RISTRETTO_WNAF_SINGLE_TABLE_BITS > 8 \
+    || RISTRETTO_WNAF_VAR_TABLE_BITS < 1 || RISTRETTO_WNAF_VAR_TABLE_BITS > RISTRETTO_WNAF_SINGLE_TABLE_BITS
+#error "wNAF table bits must be between 1 and 8, with VAR no larger than SINGLE"
+#endif
+#if RISTRETTO_FANOUT_BATCH < 1 || RISTRETTO_PRECOMPUTE_BATCH < 1 || RISTRETTO_PRECOMPUTE_MAX_THREADS < 1 \
+    || RISTRETTO_SUM_LANES < 1 || RISTRETTO_SUM_MAX_THREADS < 1
+#error "batch sizes and thread limits must be positive"
+#endif
+
+/* The scalarmuls add these to the scalar before recoding it into signed
+ * digits: 2^b-1 mod q, for b the bits covered by the windows or combs.
+ * ristretto_gen_tables computes them. */
+#define RISTRETTO_WINDOW_COVERED_BITS \
+    ((RISTRETTO255_SCALAR_BITS + RISTRETTO_WINDOW_BITS - 1) / RISTRETTO_WINDOW_BITS * RISTRETTO_WINDOW_BITS)
+#define RISTRETTO_COMBS_COVERED_BITS (COMBS_N*COMBS_T*COMBS_S)
+
+#endif /* __RISTRETTO_CONFIG_H__ */
@@ -16,14 +16,17 @@
 #include <ristretto255.h>
 #include "field.h"
 #include "f_field.h"
+#include "ristretto_config.h"
 
 static const unsigned char base_point_ser_for_pregen[SER_BYTES] = {
     0xe2, 0xf2, 0xae, 0x0a, 0x6a, 0xbc, 0x4e, 0x71, 0xa8, 0x84, 0xa9, 0x61, 0xc5, 0x00, 0x51, 0x5f, 0x58, 0xe3, 0x0b, 0x6a, 0xa5, 0x82, 0xdd, 0x8d, 0xb6, 0xa6, 0x59, 0x45, 0xe0, 0x8d, 0x2d, 0x76
 };
 
 /* To satisfy linker. */
-const gf_25519_t ristretto255_precomputed_base_as_fe[1];
+const ristretto_word_t ristretto255_precomputed_base_as_words[1];
 const ristretto255_point_t ristretto255_point_base;
+const ristretto255_scalar_t ristretto255_point_scalarmul_adjustment;
+const ristretto255_scalar_t ristretto255_precomputed_scalarmul_adjustment;
 
 struct niels_s;
 const gf_25519_t *ristretto255_precomputed_wnaf_as_fe;
@@ -55,6 +58,26 @@ static void field_print(const gf_25519_t *f) {
     assert(b<8);
 }
 
+/* Print 2^bits - 1 mod q */
+static void adjustment_print(const char *name, unsigned int bits) {
+    unsigned char ones[64] = {0}, ser[RISTRETTO255_SCALAR_BYTES];
+    ristretto255_scalar_t adj;
+    unsigned int i, j;
+
+    assert(bits <= 8*sizeof(ones));
+    for (i=0; i<bits; i++) ones[i/8] |= 1<<(i%8);
+    ristretto255_scalar_decode_long(&adj, ones, sizeof(ones));
+    ristretto255_scalar_encode(ser, &adj);
+
+    printf("const ristretto255_scalar_t %s = {{\n   ", name);
+    for (i=0; i<sizeof(ser); i+=8) {
+        unsigned long long limb = 0;
+        for (j=0; j<8; j++) limb |= (unsigned long long)ser[i+j] << (8*j);
+        printf("%s SC_LIMB(0x%016llx)", i ? "," : "", limb);
+    }
+    printf("\n}};\n");
+}
+
 int main(int argc, char **argv) {
     (void)argc; (void)argv;
 
@@ -97,14 +120,16 @@ int main(int argc, char **argv) {
     }
     printf("\n};\n");
 
-    output = (const gf_25519_t *)pre;
-    printf("const gf_25519_t ristretto255_precomputed_base_as_fe[%d]\n",
-        (int)(ristretto255_sizeof_precomputed_s / sizeof(gf_25519_t)));
-    printf("VECTOR_ALIGNED = {\n  ");
+    /* The comb is packed for constant_time_lookup_aligned, so it is printed
+     * as the words of this build rather than as field literals */
+    const ristretto_word_t *words = (const ristretto_word_t *)pre;
+    printf("const ristretto_word_t ristretto255_precomputed_base_as_words[%d]\n",
+        (int)(ristretto255_sizeof_precomputed_s / sizeof(ristretto_word_t)));
+    printf("LOOKUP_ALIGNED = {\n  ");
 
-    for (i=0; i < ristretto255_sizeof_precomputed_s; i+=sizeof(gf_25519_t)) {
-        if (i) printf(",\n  ");
-        field_print(output++);
+    for (i=0; i < ristretto255_sizeof_precomputed_s / sizeof(ristretto_word_t); i++) {
+        if (i) printf(i%4 ? ", " : ",\n  ");
+        printf("0x%0*llx", (int)(2*sizeof(ristretto_word_t)), (unsigned long long)words[i]);
     }
     printf("\n};\n");
 
@@ -118,5 +143,8 @@ int main(int argc, char **argv) {
     }
     printf("\n};\n");
 
+    adjustment_print("ristretto255_point_scalarmul_adjustment", RISTRETTO_WINDOW_COVERED_BITS);
+    adjustment_print("ristretto255_precomputed_scalarmul_adjustment", RISTRETTO_COMBS_COVERED_BITS);
+
     return 0;
 }
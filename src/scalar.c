@@ -333,3 +333,265 @@ void ristretto255_scalar_halve (
     out->limb[i] = out->limb[i]>>1 | chain<<(WBITS-1);
 }
 
+
+/* Batched scalar arithmetic.
+ *
+ * With AVX2, four scalars at a time are held in struct-of-arrays form:
+ * ten 26-bit digits, each in a 64-bit lane.  Digit products are then
+ * 52 bits, so whole columns of a product can be accumulated without
+ * carrying, vpmuludq does all the multiplies, and every step of the
+ * reduction is the same instruction on all four lanes.
+ */
+#if __AVX2__ && RISTRETTO_WORD_BITS == 64
+
+#define SC_DIGIT_BITS 26
+#define SC_DIGITS 10
+#define SC_DIGIT_MASK ((1ull<<SC_DIGIT_BITS)-1)
+
+typedef struct { uint64x4_t d[SC_DIGITS]; } sc_x4_t;
+
+/* 2^(26*(10+k)) mod p, in 26-bit digits */
+static const uint64_t sc_fold_x4[SC_DIGITS][SC_DIGITS] = {
+    {0x321e6ed, 0x3d22f59, 0x067e45a, 0x0eead6b, 0x335e51b, 0x3fffffa, 0x3ffffff, 0x3ffffff, 0x3ffffff, 0x003ffff},
+    {0x0f5d3ed, 0x2c4d997, 0x106ce43, 0x2150ab8, 0x1890086, 0x3210621, 0x3fffffa, 0x3ffffff, 0x3ffffff, 0x003ffff},
+    {0x0f5d3ed, 0x098c697, 0x3f97881, 0x2b3f4a0, 0x2af5dd3, 0x174218c, 0x3210621, 0x3fffffa, 0x3ffffff, 0x003ffff},
+    {0x0f5d3ed, 0x098c697, 0x1cd6581, 0x1a69ede, 0x34e47bc, 0x29a7ed9, 0x174218c, 0x3210621, 0x3fffffa, 0x003ffff},
+    {0x0f5d3ed, 0x098c697, 0x1cd6581, 0x37a8bde, 0x240f1f9, 0x33968c2, 0x29a7ed9, 0x174218c, 0x3210621, 0x003fffa},
+    {0x2e9fcd8, 0x14c6548, 0x3e9b9ff, 0x389f0e9, 0x0eba801, 0x22c131b, 0x33968c2, 0x29a7ed9, 0x174218c, 0x0010621},
+    {0x1d275e7, 0x3077341, 0x16bc8a1, 0x2b32fd8, 0x37cdfa7, 0x0e65046, 0x22c131b, 0x33968c2, 0x29a7ed9, 0x000218c},
+    {0x325f852, 0x0a80e24, 0x2af1439, 0x3ca90c8, 0x104410e, 0x37c309a, 0x0e65046, 0x22c131b, 0x33968c2, 0x0027ed9},
+    {0x0e5924a, 0x2f4cdfc, 0x278b71c, 0x11f7eb3, 0x3447bda, 0x0f73bb1, 0x37c309a, 0x0e65046, 0x22c131b, 0x00168c2},
+    {0x2a45451, 0x2c4b517, 0x3e51c19, 0x01dfc3a, 0x16ffd24, 0x33d217f, 0x0f73bb1, 0x37c309a, 0x0e65046, 0x000131b}
+};
+
+/* p - 2^252, in 26-bit digits */
+#define SC_C_DIGITS 5
+static const uint64_t sc_c_x4[SC_C_DIGITS] = {
+    0x0f5d3ed, 0x098c697, 0x1cd6581, 0x37a8bde, 0x014def9
+};
+
+static RISTRETTO_INLINE uint64x4_t sc4_set1(uint64_t x) {
+    uint64x4_t ret = {x,x,x,x};
+    return ret;
+}
+
+static RISTRETTO_INLINE uint64x4_t sc4_mul(uint64x4_t a, uint64x4_t b) {
+    /* Low 32 bits of each lane times low 32 bits of each lane */
+    return (uint64x4_t)_mm256_mul_epu32((__m256i)a, (__m256i)b);
+}
+
+/** Load scalars in[0..3] into struct-of-arrays form */
+static void sc_x4_load(sc_x4_t *out, const scalar_t *in) {
+    const uint64x4_t mask = sc4_set1(SC_DIGIT_MASK);
+    uint64x4_t l[SCALAR_LIMBS];
+    unsigned int i;
+    for (i=0; i<SCALAR_LIMBS; i++) {
+        uint64x4_t v = {in[0].limb[i], in[1].limb[i], in[2].limb[i], in[3].limb[i]};
+        l[i] = v;
+    }
+    out->d[0] = l[0] & mask;
+    out->d[1] = (l[0]>>26) & mask;
+    out->d[2] = (l[0]>>52 | l[1]<<12) & mask;
+    out->d[3] = (l[1]>>14) & mask;
+    out->d[4] = (l[1]>>40 | l[2]<<24) & mask;
+    out->d[5] = (l[2]>>2) & mask;
+    out->d[6] = (l[2]>>28) & mask;
+    out->d[7] = (l[2]>>54 | l[3]<<10) & mask;
+    out->d[8] = (l[3]>>16) & mask;
+    out->d[9] = l[3]>>42;
+}
+
+/** Load one scalar into all four lanes */
+static void sc_x4_set1(sc_x4_t *out, const scalar_t *in) {
+    scalar_t tmp[4];
+    unsigned int i;
+    for (i=0; i<4; i++) tmp[i] = *in;
+    sc_x4_load(out, tmp);
+}
+
+/** Store a fully reduced struct-of-arrays block to out[0..3] */
+static void sc_x4_store(scalar_t *out, const sc_x4_t *in) {
+    const uint64x4_t *d = in->d;
+    uint64x4_t l[SCALAR_LIMBS];
+    unsigned int i, lane;
+    l[0] = d[0] | d[1]<<26 | d[2]<<52;
+    l[1] = d[2]>>12 | d[3]<<14 | d[4]<<40;
+    l[2] = d[4]>>24 | d[5]<<2 | d[6]<<28 | d[7]<<54;
+    l[3] = d[7]>>10 | d[8]<<16 | d[9]<<42;
+    for (lane=0; lane<4; lane++) {
+        for (i=0; i<SCALAR_LIMBS; i++) out[lane].limb[i] = l[i][lane];
+    }
+}
+
+/** out = a - p if that is nonnegative, else a.  Requires a < 2p and a normalized. */
+static RISTRETTO_INLINE void sc_x4_reduce_once(sc_x4_t *out, const sc_x4_t *a, const sc_x4_t *p) {
+    int64x4_t chain = {0,0,0,0};
+    uint64x4_t diff[SC_DIGITS];
+    unsigned int i;
+    for (i=0; i<SC_DIGITS; i++) {
+        chain += (int64x4_t)a->d[i] - (int64x4_t)p->d[i];
+        diff[i] = (uint64x4_t)chain & SC_DIGIT_MASK;
+        chain >>= SC_DIGIT_BITS;
+    }
+    /* chain is now 0 if a >= p, or -1 if a < p */
+    uint64x4_t keep = (uint64x4_t)chain;
+    for (i=0; i<SC_DIGITS; i++) {
+        out->d[i] = (a->d[i] & keep) | (diff[i] & ~keep);
+    }
+}
+
+/** Carry a block with unreduced digits so that every digit fits in 26 bits. */
+static RISTRETTO_INLINE void sc_x4_carry(uint64x4_t *d, unsigned int n) {
+    unsigned int i;
+    for (i=0; i<n-1; i++) {
+        d[i+1] += d[i] >> SC_DIGIT_BITS;
+        d[i] &= SC_DIGIT_MASK;
+    }
+}
+
+/** out = a*b mod p, for a,b < p */
+static RISTRETTO_NOINLINE void sc_x4_mul (
+    sc_x4_t *out,
+    const sc_x4_t *a,
+    const sc_x4_t *b,
+    const sc_x4_t *p
+) {
+    const uint64x4_t mask = sc4_set1(SC_DIGIT_MASK);
+    uint64x4_t t[2*SC_DIGITS], q;
+    int64x4_t chain = {0,0,0,0};
+    sc_x4_t lo, hi;
+    unsigned int i,j;
+
+    /* Columns of the product: each is less than 10*2^52 */
+    for (i=0; i<2*SC_DIGITS; i++) t[i] = sc4_set1(0);
+    for (i=0; i<SC_DIGITS; i++) {
+        for (j=0; j<SC_DIGITS; j++) {
+            t[i+j] += sc4_mul(a->d[i], b->d[j]);
+        }
+    }
+    sc_x4_carry(t, 2*SC_DIGITS);
+
+    /* Fold the top ten digits down.  The result is < 9*2^26*p + 2^12*p < 2^283 */
+    for (i=0; i<SC_DIGITS; i++) {
+        for (j=0; j<SC_DIGITS; j++) {
+            t[j] += sc4_mul(t[SC_DIGITS+i], sc4_set1(sc_fold_x4[i][j]));
+        }
+    }
+    sc_x4_carry(t, SC_DIGITS);
+
+    /* Subtract q*p for q = floor(t/2^252) < 2^31, by clearing the top bits
+     * and subtracting q*(p-2^252).  This leaves a value in (-2^156, 2^252).
+     */
+    q = t[SC_DIGITS-1] >> (252 - SC_DIGIT_BITS*(SC_DIGITS-1));
+    t[SC_DIGITS-1] &= (1ull<<(252 - SC_DIGIT_BITS*(SC_DIGITS-1)))-1;
+    for (i=0; i<SC_DIGITS; i++) {
+        chain += (int64x4_t)t[i];
+        if (i < SC_C_DIGITS) chain -= (int64x4_t)sc4_mul(q, sc4_set1(sc_c_x4[i]));
+        lo.d[i] = (uint64x4_t)chain & mask;
+        chain >>= SC_DIGIT_BITS;
+    }
+
+    /* chain is now -1 if the value is negative; if so, add p */
+    uint64x4_t neg = (uint64x4_t)chain;
+    chain ^= chain;
+    for (i=0; i<SC_DIGITS; i++) {
+        chain += (int64x4_t)(lo.d[i] + p->d[i]);
+        hi.d[i] = (uint64x4_t)chain & mask;
+        chain >>= SC_DIGIT_BITS;
+    }
+    for (i=0; i<SC_DIGITS; i++) {
+        out->d[i] = (lo.d[i] & ~neg) | (hi.d[i] & neg);
+    }
+
+    ristretto_bzero(t, sizeof(t));
+    ristretto_bzero(&lo, sizeof(lo));
+    ristretto_bzero(&hi, sizeof(hi));
+}
+
+static void sc_x4_add(sc_x4_t *out, const sc_x4_t *a, const sc_x4_t *b, const sc_x4_t *p) {
+    sc_x4_t sum;
+    unsigned int i;
+    for (i=0; i<SC_DIGITS; i++) sum.d[i] = a->d[i] + b->d[i];
+    sc_x4_carry(sum.d, SC_DIGITS);
+    sc_x4_reduce_once(out, &sum, p);
+}
+
+static void sc_x4_sub(sc_x4_t *out, const sc_x4_t *a, const sc_x4_t *b, const sc_x4_t *p) {
+    sc_x4_t diff;
+    unsigned int i;
+    /* a + p - b is in [1, 2p) */
+    for (i=0; i<SC_DIGITS; i++) diff.d[i] = (a->d[i] + p->d[i]) - b->d[i];
+    for (i=0; i<SC_DIGITS-1; i++) {
+        diff.d[i+1] += (uint64x4_t)((int64x4_t)diff.d[i] >> SC_DIGIT_BITS);
+        diff.d[i] &= SC_DIGIT_MASK;
+    }
+    sc_x4_reduce_once(out, &diff, p);
+}
+
+#endif /* __AVX2__ && RISTRETTO_WORD_BITS == 64 */
+
+void ristretto255_scalar_mul_batch (
+    scalar_t *out,
+    const scalar_t *a,
+    const scalar_t *b,
+    size_t n
+) {
+    size_t i = 0;
+#if __AVX2__ && RISTRETTO_WORD_BITS == 64
+    sc_x4_t p, xa, xb;
+    sc_x4_set1(&p, &sc_p);
+    for (; i+4 <= n; i+=4) {
+        sc_x4_load(&xa, &a[i]);
+        sc_x4_load(&xb, &b[i]);
+        sc_x4_mul(&xa, &xa, &xb, &p);
+        sc_x4_store(&out[i], &xa);
+    }
+    ristretto_bzero(&xa, sizeof(xa));
+    ristretto_bzero(&xb, sizeof(xb));
+#endif
+    for (; i<n; i++) ristretto255_scalar_mul(&out[i], &a[i], &b[i]);
+}
+
+void ristretto255_scalar_add_batch (
+    scalar_t *out,
+    const scalar_t *a,
+    const scalar_t *b,
+    size_t n
+) {
+    size_t i = 0;
+#if __AVX2__ && RISTRETTO_WORD_BITS == 64
+    sc_x4_t p, xa, xb;
+    sc_x4_set1(&p, &sc_p);
+    for (; i+4 <= n; i+=4) {
+        sc_x4_load(&xa, &a[i]);
+        sc_x4_load(&xb, &b[i]);
+        sc_x4_add(&xa, &xa, &xb, &p);
+        sc_x4_store(&out[i], &xa);
+    }
+    ristretto_bzero(&xa, sizeof(xa));
+    ristretto_bzero(&xb, sizeof(xb));
+#endif
+    for (; i<n; i++) ristretto255_scalar_add(&out[i], &a[i], &b[i]);
+}
+
+void ristretto255_scalar_sub_batch (
+    scalar_t *out,
+    const scalar_t *a,
+    const scalar_t *b,
+    size_t n
+) {
+    size_t i = 0;
+#if __AVX2__ && RISTRETTO_WORD_BITS == 64
+    sc_x4_t p, xa, xb;
+    sc_x4_set1(&p, &sc_p);
+    for (; i+4 <= n; i+=4) {
+        sc_x4_load(&xa, &a[i]);
+        sc_x4_load(&xb, &b[i]);
+        sc_x4_sub(&xa, &xa, &xb, &p);
+        sc_x4_store(&out[i], &xa);
+    }
+    ristretto_bzero(&xa, sizeof(xa));
+    ristretto_bzero(&xb, sizeof(xb));
+#endif
+    for (; i<n; i++) ristretto255_scalar_sub(&out[i], &a[i], &b[i]);
+}
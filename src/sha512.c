@@ -0,0 +1,315 @@
+/**
+ * @file sha512.c
+ * @author Mike Hamburg
+ *
+ * @copyright
+ *   Copyright (c) 2015-2018 Ristretto Developers, Cryptography Research, Inc.  \n
+ *   Released under the MIT License.  See LICENSE.txt for license information.
+ *
+ * @brief SHA-512 implementation, for hashing to the group.
+ */
+
+#include <ristretto255.h>
+#include <string.h>
+#include <assert.h>
+#include "word.h"
+#include "sha512.h"
+
+static const uint64_t sha512_k[80] = {
+    0x428a2f98d728ae22ull, 0x7137449123ef65cdull, 0xb5c0fbcfec4d3b2full, 0xe9b5dba58189dbbcull,
+    0x3956c25bf348b538ull, 0x59f111f1b605d019ull, 0x923f82a4af194f9bull, 0xab1c5ed5da6d8118ull,
+    0xd807aa98a3030242ull, 0x12835b0145706fbeull, 0x243185be4ee4b28cull, 0x550c7dc3d5ffb4e2ull,
+    0x72be5d74f27b896full, 0x80deb1fe3b1696b1ull, 0x9bdc06a725c71235ull, 0xc19bf174cf692694ull,
+    0xe49b69c19ef14ad2ull, 0xefbe4786384f25e3ull, 0x0fc19dc68b8cd5b5ull, 0x240ca1cc77ac9c65ull,
+    0x2de92c6f592b0275ull, 0x4a7484aa6ea6e483ull, 0x5cb0a9dcbd41fbd4ull, 0x76f988da831153b5ull,
+    0x983e5152ee66dfabull, 0xa831c66d2db43210ull, 0xb00327c898fb213full, 0xbf597fc7beef0ee4ull,
+    0xc6e00bf33da88fc2ull, 0xd5a79147930aa725ull, 0x06ca6351e003826full, 0x142929670a0e6e70ull,
+    0x27b70a8546d22ffcull, 0x2e1b21385c26c926ull, 0x4d2c6dfc5ac42aedull, 0x53380d139d95b3dfull,
+    0x650a73548baf63deull, 0x766a0abb3c77b2a8ull, 0x81c2c92e47edaee6ull, 0x92722c851482353bull,
+    0xa2bfe8a14cf10364ull, 0xa81a664bbc423001ull, 0xc24b8b70d0f89791ull, 0xc76c51a30654be30ull,
+    0xd192e819d6ef5218ull, 0xd69906245565a910ull, 0xf40e35855771202aull, 0x106aa07032bbd1b8ull,
+    0x19a4c116b8d2d0c8ull, 0x1e376c085141ab53ull, 0x2748774cdf8eeb99ull, 0x34b0bcb5e19b48a8ull,
+    0x391c0cb3c5c95a63ull, 0x4ed8aa4ae3418acbull, 0x5b9cca4f7763e373ull, 0x682e6ff3d6b2b8a3ull,
+    0x748f82ee5defb2fcull, 0x78a5636f43172f60ull, 0x84c87814a1f0ab72ull, 0x8cc702081a6439ecull,
+    0x90befffa23631e28ull, 0xa4506cebde82bde9ull, 0xbef9a3f7b2c67915ull, 0xc67178f2e372532bull,
+    0xca273eceea26619cull, 0xd186b8c721c0c207ull, 0xeada7dd6cde0eb1eull, 0xf57d4f7fee6ed178ull,
+    0x06f067aa72176fbaull, 0x0a637dc5a2c898a6ull, 0x113f9804bef90daeull, 0x1b710b35131c471bull,
+    0x28db77f523047d84ull, 0x32caab7b40c72493ull, 0x3c9ebe0a15c9bebcull, 0x431d67c49c100d4cull,
+    0x4cc5d4becb3e42b6ull, 0x597f299cfc657e2aull, 0x5fcb6fab3ad6faecull, 0x6c44198c4a475817ull
+};
+
+const uint64_t ristretto255_sha512_init_state[8] = {
+    0x6a09e667f3bcc908ull, 0xbb67ae8584caa73bull, 0x3c6ef372fe94f82bull, 0xa54ff53a5f1d36f1ull,
+    0x510e527fade682d1ull, 0x9b05688c2b3e6c1full, 0x1f83d9abfb41bd6bull, 0x5be0cd19137e2179ull
+};
+
+static RISTRETTO_INLINE uint64_t rotr64(uint64_t x, unsigned int n) {
+    return (x >> n) | (x << (64-n));
+}
+
+static RISTRETTO_INLINE uint64_t load_be64(const uint8_t *in) {
+    uint64_t ret = 0;
+    unsigned int i;
+    for (i=0; i<8; i++) ret = ret<<8 | in[i];
+    return ret;
+}
+
+static RISTRETTO_INLINE void store_be64(uint8_t *out, uint64_t x) {
+    unsigned int i;
+    for (i=0; i<8; i++) out[i] = (uint8_t)(x >> (56-8*i));
+}
+
+void ristretto255_sha512_compress (
+    uint64_t state[8],
+    const uint8_t *blocks,
+    size_t nblocks
+) {
+    uint64_t w[80], a, b, c, d, e, f, g, h, t1, t2;
+    unsigned int i;
+
+    for (; nblocks; nblocks--, blocks += RISTRETTO255_SHA512_BLOCK_BYTES) {
+        for (i=0; i<16; i++) w[i] = load_be64(&blocks[8*i]);
+        for (; i<80; i++) {
+            uint64_t s0 = rotr64(w[i-15],1) ^ rotr64(w[i-15],8) ^ (w[i-15]>>7);
+            uint64_t s1 = rotr64(w[i-2],19) ^ rotr64(w[i-2],61) ^ (w[i-2]>>6);
+            w[i] = w[i-16] + s0 + w[i-7] + s1;
+        }
+
+        a = state[0]; b = state[1]; c = state[2]; d = state[3];
+        e = state[4]; f = state[5]; g = state[6]; h = state[7];
+
+        for (i=0; i<80; i++) {
+            t1 = h + (rotr64(e,14) ^ rotr64(e,18) ^ rotr64(e,41))
+                   + ((e & f) ^ (~e & g)) + sha512_k[i] + w[i];
+            t2 = (rotr64(a,28) ^ rotr64(a,34) ^ rotr64(a,39))
+                   + ((a & b) ^ (a & c) ^ (b & c));
+            h = g; g = f; f = e; e = d + t1;
+            d = c; c = b; b = a; a = t1 + t2;
+        }
+
+        state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+        state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+    }
+
+    ristretto_bzero(w, sizeof(w));
+}
+
+void ristretto255_sha512_init (ristretto255_sha512_ctx_t *ctx) {
+    memcpy(ctx->state, ristretto255_sha512_init_state, sizeof(ctx->state));
+    ctx->bytes_processed = 0;
+}
+
+void ristretto255_sha512_update (
+    ristretto255_sha512_ctx_t *ctx,
+    const uint8_t *message,
+    size_t message_len
+) {
+    size_t fill = ctx->bytes_processed % RISTRETTO255_SHA512_BLOCK_BYTES;
+    if (!message_len) return;
+    ctx->bytes_processed += message_len;
+
+    if (fill) {
+        size_t take = RISTRETTO255_SHA512_BLOCK_BYTES - fill;
+        if (take > message_len) take = message_len;
+        memcpy(&ctx->block[fill], message, take);
+        message += take;
+        message_len -= take;
+        if (fill + take < RISTRETTO255_SHA512_BLOCK_BYTES) return;
+        ristretto255_sha512_compress(ctx->state, ctx->block, 1);
+    }
+
+    /* Whole blocks go straight from the caller's buffer */
+    ristretto255_sha512_compress(ctx->state, message, message_len / RISTRETTO255_SHA512_BLOCK_BYTES);
+    message += message_len - message_len % RISTRETTO255_SHA512_BLOCK_BYTES;
+    memcpy(ctx->block, message, message_len % RISTRETTO255_SHA512_BLOCK_BYTES);
+}
+
+void ristretto255_sha512_final (
+    ristretto255_sha512_ctx_t *ctx,
+    uint8_t out[RISTRETTO255_SHA512_OUTPUT_BYTES]
+) {
+    size_t fill = ctx->bytes_processed % RISTRETTO255_SHA512_BLOCK_BYTES;
+    unsigned int i;
+
+    ctx->block[fill++] = 0x80;
+    if (fill > RISTRETTO255_SHA512_BLOCK_BYTES - 16) {
+        memset(&ctx->block[fill], 0, RISTRETTO255_SHA512_BLOCK_BYTES - fill);
+        ristretto255_sha512_compress(ctx->state, ctx->block, 1);
+        fill = 0;
+    }
+    memset(&ctx->block[fill], 0, RISTRETTO255_SHA512_BLOCK_BYTES - 16 - fill);
+    store_be64(&ctx->block[RISTRETTO255_SHA512_BLOCK_BYTES-16], ctx->bytes_processed >> 61);
+    store_be64(&ctx->block[RISTRETTO255_SHA512_BLOCK_BYTES-8], ctx->bytes_processed << 3);
+    ristretto255_sha512_compress(ctx->state, ctx->block, 1);
+
+    for (i=0; i<8; i++) store_be64(&out[8*i], ctx->state[i]);
+    ristretto_bzero(ctx, sizeof(*ctx));
+}
+
+void ristretto255_sha512_hash (
+    uint8_t out[RISTRETTO255_SHA512_OUTPUT_BYTES],
+    const uint8_t *message,
+    size_t message_len
+) {
+    ristretto255_sha512_ctx_t ctx;
+    ristretto255_sha512_init(&ctx);
+    ristretto255_sha512_update(&ctx, message, message_len);
+    ristretto255_sha512_final(&ctx, out);
+}
+
+/* Multi-buffer hashing: one message per 64-bit lane, all running the same
+ * compression function in lockstep. */
+
+#if SHA512_MULTI_LANES > 1
+
+#if SHA512_MULTI_LANES == 8
+typedef uint64_t sha512_vec_t __attribute__((vector_size(64)));
+#else
+typedef uint64x4_t sha512_vec_t;
+#endif
+
+static RISTRETTO_INLINE sha512_vec_t rotr64_vec(sha512_vec_t x, unsigned int n) {
+    return (x >> n) | (x << (64-n));
+}
+
+static RISTRETTO_INLINE sha512_vec_t set1_vec(uint64_t x) {
+    sha512_vec_t ret;
+    unsigned int j;
+    for (j=0; j<SHA512_MULTI_LANES; j++) ret[j] = x;
+    return ret;
+}
+
+/* Compress one block per lane, given as big-endian words already transposed
+ * so that words[i] holds word i of every lane.  Lanes whose mask is zero keep their state. */
+static void sha512_compress_multi (
+    sha512_vec_t state[8],
+    const sha512_vec_t words[16],
+    sha512_vec_t active
+) {
+    sha512_vec_t w[80], a, b, c, d, e, f, g, h, t1, t2;
+    unsigned int i;
+
+    for (i=0; i<16; i++) w[i] = words[i];
+    for (; i<80; i++) {
+        sha512_vec_t s0 = rotr64_vec(w[i-15],1) ^ rotr64_vec(w[i-15],8) ^ (w[i-15]>>7);
+        sha512_vec_t s1 = rotr64_vec(w[i-2],19) ^ rotr64_vec(w[i-2],61) ^ (w[i-2]>>6);
+        w[i] = w[i-16] + s0 + w[i-7] + s1;
+    }
+
+    a = state[0]; b = state[1]; c = state[2]; d = state[3];
+    e = state[4]; f = state[5]; g = state[6]; h = state[7];
+
+    for (i=0; i<80; i++) {
+        t1 = h + (rotr64_vec(e,14) ^ rotr64_vec(e,18) ^ rotr64_vec(e,41))
+               + ((e & f) ^ (~e & g)) + sha512_k[i] + w[i];
+        t2 = (rotr64_vec(a,28) ^ rotr64_vec(a,34) ^ rotr64_vec(a,39))
+               + ((a & b) ^ (a & c) ^ (b & c));
+        h = g; g = f; f = e; e = d + t1;
+        d = c; c = b; b = a; a = t1 + t2;
+    }
+
+    state[0] += a & active; state[1] += b & active;
+    state[2] += c & active; state[3] += d & active;
+    state[4] += e & active; state[5] += f & active;
+    state[6] += g & active; state[7] += h & active;
+
+    ristretto_bzero(w, sizeof(w));
+}
+
+/* Write block k of the padded message into block */
+static void sha512_multi_block (
+    uint8_t block[RISTRETTO255_SHA512_BLOCK_BYTES],
+    const sha512_multi_msg_t *msg,
+    size_t total,
+    size_t nblocks,
+    size_t k,
+    uint64_t init_bytes
+) {
+    size_t start = k * RISTRETTO255_SHA512_BLOCK_BYTES, off = 0, fill = 0;
+    unsigned int i;
+
+    memset(block, 0, RISTRETTO255_SHA512_BLOCK_BYTES);
+    for (i=0; i<3 && fill < RISTRETTO255_SHA512_BLOCK_BYTES; i++) {
+        size_t len = msg->part_len[i], skip, take;
+        if (!len || off + len <= start) { off += len; continue; }
+        skip = start > off ? start - off : 0;
+        take = len - skip;
+        if (take > RISTRETTO255_SHA512_BLOCK_BYTES - fill) take = RISTRETTO255_SHA512_BLOCK_BYTES - fill;
+        memcpy(&block[fill], msg->part[i] + skip, take);
+        fill += take;
+        off += len;
+    }
+
+    if (total >= start && total < start + RISTRETTO255_SHA512_BLOCK_BYTES) block[total - start] = 0x80;
+    if (k == nblocks - 1) {
+        uint64_t bytes = init_bytes + total;
+        store_be64(&block[RISTRETTO255_SHA512_BLOCK_BYTES-16], bytes >> 61);
+        store_be64(&block[RISTRETTO255_SHA512_BLOCK_BYTES-8], bytes << 3);
+    }
+}
+
+void ristretto255_sha512_multi (
+    uint8_t out[][RISTRETTO255_SHA512_OUTPUT_BYTES],
+    const uint64_t init_state[8],
+    uint64_t init_bytes,
+    const sha512_multi_msg_t *msgs,
+    unsigned int n
+) {
+    uint8_t block[RISTRETTO255_SHA512_BLOCK_BYTES];
+    sha512_vec_t words[16];
+    size_t total[SHA512_MULTI_LANES], nblocks[SHA512_MULTI_LANES], k, max_blocks = 0;
+    sha512_vec_t state[8];
+    unsigned int i, j;
+
+    assert(n <= SHA512_MULTI_LANES);
+    for (j=0; j<SHA512_MULTI_LANES; j++) {
+        total[j] = nblocks[j] = 0;
+        if (j >= n) continue;
+        for (i=0; i<3; i++) total[j] += msgs[j].part_len[i];
+        nblocks[j] = (total[j] + 16 + RISTRETTO255_SHA512_BLOCK_BYTES) / RISTRETTO255_SHA512_BLOCK_BYTES;
+        if (nblocks[j] > max_blocks) max_blocks = nblocks[j];
+    }
+    for (i=0; i<8; i++) state[i] = set1_vec(init_state[i]);
+    for (i=0; i<16; i++) words[i] = set1_vec(0);
+
+    for (k=0; k<max_blocks; k++) {
+        sha512_vec_t active;
+        for (j=0; j<SHA512_MULTI_LANES; j++) {
+            active[j] = -(uint64_t)(k < nblocks[j]);
+            if (k < nblocks[j]) {
+                sha512_multi_block(block, &msgs[j], total[j], nblocks[j], k, init_bytes);
+                for (i=0; i<16; i++) words[i][j] = load_be64(&block[8*i]);
+            }
+        }
+        sha512_compress_multi(state, words, active);
+    }
+
+    for (j=0; j<n; j++) {
+        for (i=0; i<8; i++) store_be64(&out[j][8*i], state[i][j]);
+    }
+    ristretto_bzero(block, sizeof(block));
+    ristretto_bzero(words, sizeof(words));
+    ristretto_bzero(state, sizeof(state));
+}
+
+#else /* SHA512_MULTI_LANES == 1 */
+
+void ristretto255_sha512_multi (
+    uint8_t out[][RISTRETTO255_SHA512_OUTPUT_BYTES],
+    const uint64_t init_state[8],
+    uint64_t init_bytes,
+    const sha512_multi_msg_t *msgs,
+    unsigned int n
+) {
+    ristretto255_sha512_ctx_t ctx;
+    unsigned int i, j;
+
+    for (j=0; j<n; j++) {
+        memcpy(ctx.state, init_state, sizeof(ctx.state));
+        ctx.bytes_processed = init_bytes;
+        for (i=0; i<3; i++) ristretto255_sha512_update(&ctx, msgs[j].part[i], msgs[j].part_len[i]);
+        ristretto255_sha512_final(&ctx, out[j]);
+    }
+}
+
+#endif /* SHA512_MULTI_LANES */
@@ -0,0 +1,60 @@
+/**
+ * @file sha512.h
+ * @author Mike Hamburg
+ *
+ * @copyright
+ *   Copyright (c) 2015-2018 Ristretto Developers, Cryptography Research, Inc.  \n
+ *   Released under the MIT License.  See LICENSE.txt for license information.
+ *
+ * @brief SHA-512 internals shared by the hashing code.
+ */
+
+#ifndef __RISTRETTO_SHA512_H__
+#define __RISTRETTO_SHA512_H__ 1
+
+#include <ristretto255.h>
+
+/** The SHA-512 initial hash value */
+extern const uint64_t ristretto255_sha512_init_state[8];
+
+/** Run the compression function over nblocks whole blocks. */
+void ristretto255_sha512_compress (
+    uint64_t state[8],
+    const uint8_t *blocks,
+    size_t nblocks
+);
+
+/**
+ * Number of messages the multi-buffer engine hashes side by side: one per
+ * 64-bit lane of the widest vector unit available.
+ */
+#if __AVX512F__
+#define SHA512_MULTI_LANES 8
+#elif __AVX2__
+#define SHA512_MULTI_LANES 4
+#else
+#define SHA512_MULTI_LANES 1
+#endif
+
+/** One message for the multi-buffer engine: the concatenation of its parts. */
+typedef struct {
+    const uint8_t *part[3];
+    size_t part_len[3];
+} sha512_multi_msg_t;
+
+/**
+ * Hash up to SHA512_MULTI_LANES messages at once, each starting from
+ * init_state after init_bytes bytes (a whole number of blocks) have already
+ * been absorbed, so that a shared prefix such as the xmd Z_pad block is only
+ * compressed once.
+ * Messages may have different lengths; the lanes of shorter ones idle.
+ */
+void ristretto255_sha512_multi (
+    uint8_t out[][RISTRETTO255_SHA512_OUTPUT_BYTES],
+    const uint64_t init_state[8],
+    uint64_t init_bytes,
+    const sha512_multi_msg_t *msgs,
+    unsigned int n
+);
+
+#endif /* __RISTRETTO_SHA512_H__ */
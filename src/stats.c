@@ -0,0 +1,34 @@
+/* Copyright (c) 2015-2018 Ristretto Developers, Cryptography Research, Inc.
+ * Released under the MIT License.  See LICENSE.txt for license information.
+ */
+
+/**
+ * @file stats.c
+ * @author Mike Hamburg
+ * @brief Snapshot and reset of the operation counters
+ */
+
+#include "stats.h"
+#include <string.h>
+
+#ifdef RISTRETTO_STATS
+__thread ristretto255_stats_t ristretto_stats;
+#endif
+
+ristretto_bool_t ristretto255_stats_snapshot (
+    ristretto255_stats_t *stats
+) {
+#ifdef RISTRETTO_STATS
+    *stats = ristretto_stats;
+    return RISTRETTO_TRUE;
+#else
+    memset(stats, 0, sizeof(*stats));
+    return RISTRETTO_FALSE;
+#endif
+}
+
+void ristretto255_stats_reset (void) {
+#ifdef RISTRETTO_STATS
+    memset(&ristretto_stats, 0, sizeof(ristretto_stats));
+#endif
+}
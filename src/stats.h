@@ -0,0 +1,22 @@
+/**
+ * @file stats.h
+ * @copyright
+ *   Copyright (c) 2015-2018 Ristretto Developers, Cryptography Research, Inc.  \n
+ *   Released under the MIT License.  See LICENSE.txt for license information.
+ * @author Mike Hamburg
+ * @brief Per-thread operation counters, compiled in with RISTRETTO_STATS.
+ */
+
+#ifndef __RISTRETTO_STATS_H__
+#define __RISTRETTO_STATS_H__ 1
+
+#include <ristretto255.h>
+
+#ifdef RISTRETTO_STATS
+extern __thread ristretto255_stats_t ristretto_stats;
+#define RISTRETTO_COUNT(op, n) (ristretto_stats.op += (n))
+#else
+#define RISTRETTO_COUNT(op, n) ((void)0)
+#endif
+
+#endif /* __RISTRETTO_STATS_H__ */
@@ -0,0 +1,248 @@
+/**
+ * @file table_file.c
+ * @author Mike Hamburg
+ *
+ * @copyright
+ *   Copyright (c) 2015-2018 Ristretto Developers, Cryptography Research, Inc.  \n
+ *   Released under the MIT License.  See LICENSE.txt for license information.
+ *
+ * @brief Versioned on-disk format for precomputed tables, and zero-copy
+ * mapping of files holding many of them.
+ */
+
+#include "word.h"
+#include "field.h"
+#include "ristretto_config.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define HEADER_BYTES RISTRETTO255_TABLE_FILE_HEADER_BYTES
+#define DIGESTED_HEADER_BYTES 64
+#define TABLE_FILE_VERSION 3
+#define GF_LIMBS (sizeof(((gf_25519_t *)0)->limb)/sizeof(ristretto_word_t))
+
+static const uint8_t table_file_magic[8] = { 'R','2','5','5','T','B','L',0 };
+
+/* Header field offsets */
+#define OFF_VERSION 8
+#define OFF_KIND 12
+#define OFF_LAYOUT 16
+#define OFF_TABLE_BYTES 20
+#define OFF_COUNT 24
+#define OFF_PAYLOAD 32
+#define OFF_CONFIG 40
+#define OFF_DIGEST 64
+
+/* Identifies the field element representation: a file is only usable by
+ * builds whose tag matches */
+static uint32_t layout_tag(void) {
+    return (uint32_t)RISTRETTO_WORD_BITS
+        | (uint32_t)GF_LIMBS << 8
+        | (uint32_t)sizeof(gf_25519_t) << 16
+        | (uint32_t)LIMB_PLACE_VALUE(0) << 24;
+}
+
+/* Identifies the table shapes: builds tuned differently can have tables of
+ * the same size laid out differently */
+static uint64_t config_tag(void) {
+    return (uint64_t)COMBS_N
+        | (uint64_t)COMBS_T << 8
+        | (uint64_t)COMBS_S << 16
+        | (uint64_t)RISTRETTO_COMPACT_COMBS << 24
+        | (uint64_t)RISTRETTO_WNAF_SINGLE_TABLE_BITS << 32;
+}
+
+static void store_le (uint8_t *out, uint64_t x, unsigned int n) {
+    unsigned int i;
+    for (i=0; i<n; i++, x>>=8) out[i] = (uint8_t)x;
+}
+
+static uint64_t load_le (const uint8_t *in, unsigned int n) {
+    uint64_t x = 0;
+    unsigned int i;
+    for (i=n; i>0; i--) x = x<<8 | in[i-1];
+    return x;
+}
+
+static size_t table_bytes_of (ristretto255_table_kind_t kind) {
+    switch (kind) {
+    case RISTRETTO255_TABLE_COMB: return ristretto255_sizeof_precomputed_s;
+    case RISTRETTO255_TABLE_WNAF: return ristretto255_sizeof_precomputed_wnaf_s;
+    default: return 0;
+    }
+}
+
+static void digest (
+    uint8_t out[RISTRETTO255_SHA512_OUTPUT_BYTES],
+    const uint8_t *file,
+    size_t payload_bytes
+) {
+    ristretto255_sha512_ctx_t ctx;
+    ristretto255_sha512_init(&ctx);
+    ristretto255_sha512_update(&ctx, file, DIGESTED_HEADER_BYTES);
+    ristretto255_sha512_update(&ctx, file+HEADER_BYTES, payload_bytes);
+    ristretto255_sha512_final(&ctx, out);
+}
+
+size_t ristretto255_table_file_bytes (
+    ristretto255_table_kind_t kind,
+    size_t count
+) {
+    size_t tb = table_bytes_of(kind);
+    if (tb == 0 || count > (SIZE_MAX - HEADER_BYTES) / tb) return 0;
+    return HEADER_BYTES + count*tb;
+}
+
+/* The payload is count tables of words, in units of unit_words of which the
+ * first live_words are stored and the rest, padding, are zeroed */
+static void table_file_encode (
+    uint8_t *out,
+    ristretto255_table_kind_t kind,
+    const ristretto_word_t *words,
+    size_t count,
+    unsigned int unit_words,
+    unsigned int live_words
+) {
+    size_t tb = table_bytes_of(kind), n = count * (tb/sizeof(ristretto_word_t)), i;
+    uint8_t *payload = out + HEADER_BYTES;
+
+    assert(tb % (unit_words*sizeof(ristretto_word_t)) == 0);
+    memset(out, 0, HEADER_BYTES);
+    memcpy(out, table_file_magic, sizeof(table_file_magic));
+    store_le(&out[OFF_VERSION], TABLE_FILE_VERSION, 4);
+    store_le(&out[OFF_KIND], (uint64_t)kind, 4);
+    store_le(&out[OFF_LAYOUT], layout_tag(), 4);
+    store_le(&out[OFF_TABLE_BYTES], tb, 4);
+    store_le(&out[OFF_COUNT], count, 8);
+    store_le(&out[OFF_PAYLOAD], HEADER_BYTES, 8);
+    store_le(&out[OFF_CONFIG], config_tag(), 8);
+
+    for (i=0; i<n; i++, payload += sizeof(ristretto_word_t)) {
+        store_le(payload, i%unit_words < live_words ? words[i] : 0, sizeof(ristretto_word_t));
+    }
+
+    digest(&out[OFF_DIGEST], out, count*tb);
+}
+
+void ristretto255_table_file_encode_comb (
+    uint8_t *out,
+    const ristretto255_precomputed_s *tables,
+    size_t count
+) {
+    /* Comb entries are packed, with their padding already zero */
+    table_file_encode(out, RISTRETTO255_TABLE_COMB, (const ristretto_word_t *)tables, count, 1, 1);
+}
+
+void ristretto255_table_file_encode_wnaf (
+    uint8_t *out,
+    const ristretto255_precomputed_wnaf_s *tables,
+    size_t count
+) {
+    table_file_encode(out, RISTRETTO255_TABLE_WNAF, (const ristretto_word_t *)tables, count,
+        sizeof(gf_25519_t)/sizeof(ristretto_word_t), GF_LIMBS);
+}
+
+ristretto_error_t ristretto255_table_file_view (
+    ristretto255_table_file_t *view,
+    const uint8_t *file,
+    size_t file_len,
+    ristretto255_table_kind_t kind,
+    ristretto_bool_t verify
+) {
+    const ristretto_word_t one = 1;
+    size_t tb = table_bytes_of(kind);
+    uint64_t count;
+    uint8_t check[RISTRETTO255_SHA512_OUTPUT_BYTES];
+    unsigned int i;
+
+    memset(view, 0, sizeof(*view));
+
+    /* The payload is used as the in-memory image, so the host must be
+     * little-endian and the table suitably aligned */
+    if (*(const uint8_t *)&one != 1) return RISTRETTO_FAILURE;
+    if ((uintptr_t)file % ristretto255_alignof_precomputed_s) return RISTRETTO_FAILURE;
+
+    if (tb == 0 || file_len < HEADER_BYTES) return RISTRETTO_FAILURE;
+    if (memcmp(file, table_file_magic, sizeof(table_file_magic))
+        || load_le(&file[OFF_VERSION], 4) != TABLE_FILE_VERSION
+        || load_le(&file[OFF_KIND], 4) != (uint64_t)kind
+        || load_le(&file[OFF_LAYOUT], 4) != layout_tag()
+        || load_le(&file[OFF_TABLE_BYTES], 4) != tb
+        || load_le(&file[OFF_PAYLOAD], 8) != HEADER_BYTES
+        || load_le(&file[OFF_CONFIG], 8) != config_tag()
+    ) {
+        return RISTRETTO_FAILURE;
+    }
+    for (i=OFF_CONFIG+8; i<DIGESTED_HEADER_BYTES; i++) {
+        if (file[i]) return RISTRETTO_FAILURE;
+    }
+
+    count = load_le(&file[OFF_COUNT], 8);
+    if (count > (file_len - HEADER_BYTES) / tb || HEADER_BYTES + count*tb != file_len) {
+        return RISTRETTO_FAILURE;
+    }
+
+    if (verify) {
+        digest(check, file, (size_t)count*tb);
+        if (memcmp(check, &file[OFF_DIGEST], sizeof(check))) return RISTRETTO_FAILURE;
+    }
+
+    view->file = file;
+    view->file_len = file_len;
+    view->table_bytes = tb;
+    view->kind = kind;
+    view->count = (size_t)count;
+    return RISTRETTO_SUCCESS;
+}
+
+ristretto_error_t ristretto255_table_file_map (
+    ristretto255_table_file_t *map,
+    const char *path,
+    ristretto255_table_kind_t kind,
+    ristretto_bool_t verify
+) {
+    struct stat st;
+    void *file;
+    ristretto_error_t ret;
+    int fd = open(path, O_RDONLY);
+
+    memset(map, 0, sizeof(*map));
+    if (fd < 0) return RISTRETTO_FAILURE;
+    if (fstat(fd, &st) || st.st_size < HEADER_BYTES || (uint64_t)st.st_size > SIZE_MAX) {
+        close(fd);
+        return RISTRETTO_FAILURE;
+    }
+
+    file = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (file == MAP_FAILED) return RISTRETTO_FAILURE;
+
+    ret = ristretto255_table_file_view(map, (const uint8_t *)file, (size_t)st.st_size, kind, verify);
+    if (ret != RISTRETTO_SUCCESS) munmap(file, (size_t)st.st_size);
+    return ret;
+}
+
+void ristretto255_table_file_unmap (
+    ristretto255_table_file_t *map
+) {
+    if (map->file) munmap((void *)map->file, map->file_len);
+    memset(map, 0, sizeof(*map));
+}
+
+const ristretto255_precomputed_s *ristretto255_table_file_comb (
+    const ristretto255_table_file_t *map,
+    size_t i
+) {
+    if (map->kind != RISTRETTO255_TABLE_COMB || i >= map->count) return NULL;
+    return (const ristretto255_precomputed_s *)(map->file + HEADER_BYTES + i*map->table_bytes);
+}
+
+const ristretto255_precomputed_wnaf_s *ristretto255_table_file_wnaf (
+    const ristretto255_table_file_t *map,
+    size_t i
+) {
+    if (map->kind != RISTRETTO255_TABLE_WNAF || i >= map->count) return NULL;
+    return (const ristretto255_precomputed_wnaf_s *)(map->file + HEADER_BYTES + i*map->table_bytes);
+}
@@ -184,6 +184,32 @@ typedef struct {
     #define br_is_zero word_is_zero
 #endif
 
+/* The register used by constant_time_lookup_aligned: a whole cache line
+ * on AVX-512, else the big register.  Tables built for it are aligned to
+ * and padded out to whole lookup registers.
+ */
+#if __AVX512F__
+    #define LOOKUP_ALIGNED __attribute__((aligned(64)))
+    typedef uint64_t lookup_register_t __attribute__((vector_size(64)));
+
+    static RISTRETTO_INLINE lookup_register_t
+    lr_set_to_mask(mask_t x) {
+        uint64_t y = (uint64_t)(int64_t)(sword_t)x;
+        lookup_register_t ret = {y,y,y,y,y,y,y,y};
+        return ret;
+    }
+
+    static RISTRETTO_INLINE lookup_register_t
+    lr_is_zero(lookup_register_t x) {
+        return (lookup_register_t)(x == lr_set_to_mask(0));
+    }
+#else
+    #define LOOKUP_ALIGNED VECTOR_ALIGNED
+    typedef big_register_t lookup_register_t;
+    #define lr_set_to_mask br_set_to_mask
+    #define lr_is_zero br_is_zero
+#endif
+
 /**
  * Really call memset, in a way that prevents the compiler from optimizing it out.
  * @param p The object to zeroize.
@@ -245,6 +271,8 @@ malloc_vector(size_t size) {
 #if 100*__clang_major__ + __clang_minor__ > 305
 #define UNROLL _Pragma("clang loop unroll(full)")
 #endif
+#elif defined(__GNUC__) && __GNUC__ >= 8
+#define UNROLL _Pragma("GCC unroll 32")
 #endif
 
 #ifndef UNROLL
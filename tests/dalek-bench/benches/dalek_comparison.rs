@@ -0,0 +1,263 @@
+//! Benchmarks of libristretto255 against curve25519-dalek.
+//!
+//! Each group times one operation through the libristretto255-sys FFI and
+//! through its curve25519-dalek equivalent, on the same inputs:
+//!
+//!     cd tests/dalek-bench && cargo bench
+//!
+//! Before anything is timed, both sides are checked to give the same
+//! result on the same inputs, so the two columns do the same work.
+
+#[macro_use]
+extern crate criterion;
+extern crate curve25519_dalek;
+extern crate libristretto255_sys;
+extern crate rand;
+extern crate sha2;
+
+use std::mem;
+
+use criterion::{Bencher, Criterion, Fun};
+use curve25519_dalek::constants::RISTRETTO_BASEPOINT_TABLE;
+use curve25519_dalek::ristretto::{CompressedRistretto, RistrettoPoint};
+use curve25519_dalek::scalar::Scalar;
+use libristretto255_sys::*;
+use rand::{OsRng, RngCore};
+use sha2::Sha512;
+
+/// The same point and scalars in both libraries' representations.
+struct Inputs {
+    hash: [u8; 64],
+    encoded: [u8; 32],
+    point: ristretto255_point_t,
+    s1: ristretto255_scalar_t,
+    s2: ristretto255_scalar_t,
+    dalek_point: RistrettoPoint,
+    dalek_s1: Scalar,
+    dalek_s2: Scalar,
+}
+
+fn random_wide(rng: &mut OsRng) -> [u8; 64] {
+    let mut bytes = [0u8; 64];
+    rng.fill_bytes(&mut bytes);
+    bytes
+}
+
+fn scalar_from_wide(bytes: &[u8; 64]) -> ristretto255_scalar_t {
+    unsafe {
+        let mut s = mem::zeroed();
+        ristretto255_scalar_decode_long(&mut s, bytes.as_ptr(), bytes.len());
+        s
+    }
+}
+
+fn encode(point: &ristretto255_point_t) -> [u8; 32] {
+    let mut out = [0u8; 32];
+    unsafe { ristretto255_point_encode(out.as_mut_ptr(), point) };
+    out
+}
+
+fn inputs() -> Inputs {
+    let mut rng = OsRng::new().unwrap();
+    let hash = random_wide(&mut rng);
+    let wide1 = random_wide(&mut rng);
+    let wide2 = random_wide(&mut rng);
+
+    let mut point = unsafe { mem::zeroed() };
+    unsafe { ristretto255_point_from_hash_uniform(&mut point, hash.as_ptr()) };
+    let dalek_point = RistrettoPoint::from_uniform_bytes(&hash);
+    let encoded = encode(&point);
+    assert_eq!(encoded, dalek_point.compress().to_bytes());
+
+    Inputs {
+        hash,
+        encoded,
+        point,
+        s1: scalar_from_wide(&wide1),
+        s2: scalar_from_wide(&wide2),
+        dalek_point,
+        dalek_s1: Scalar::from_bytes_mod_order_wide(&wide1),
+        dalek_s2: Scalar::from_bytes_mod_order_wide(&wide2),
+    }
+}
+
+/// Time both sides of a group.
+fn compare<L, D>(c: &mut Criterion, name: &str, mut lib: L, mut dalek: D)
+where
+    L: FnMut(&mut Bencher) + 'static,
+    D: FnMut(&mut Bencher) + 'static,
+{
+    c.bench_functions(
+        name,
+        vec![
+            Fun::new("libristretto255", move |b, _: &()| lib(b)),
+            Fun::new("dalek", move |b, _: &()| dalek(b)),
+        ],
+        (),
+    );
+}
+
+fn decode(c: &mut Criterion) {
+    let x = inputs();
+    let encoded = x.encoded;
+    let decode_lib = |ser: &[u8; 32]| unsafe {
+        let mut pt = mem::zeroed();
+        let ok = ristretto255_point_decode(&mut pt, ser.as_ptr(), RISTRETTO_FALSE);
+        (ok, pt)
+    };
+    let (ok, pt) = decode_lib(&encoded);
+    assert_eq!(ok, RISTRETTO_SUCCESS);
+    let dalek_pt = CompressedRistretto(encoded).decompress().unwrap();
+
+    assert_eq!(encode(&pt), dalek_pt.compress().to_bytes());
+    compare(
+        c,
+        "decode",
+        move |b| b.iter(|| decode_lib(&encoded)),
+        move |b| b.iter(|| CompressedRistretto(encoded).decompress()),
+    );
+}
+
+fn encode_point(c: &mut Criterion) {
+    let x = inputs();
+    let (point, dalek_point) = (x.point, x.dalek_point);
+
+    assert_eq!(encode(&point), dalek_point.compress().to_bytes());
+    compare(
+        c,
+        "encode",
+        move |b| b.iter(|| encode(&point)),
+        move |b| b.iter(|| dalek_point.compress()),
+    );
+}
+
+fn scalarmul(c: &mut Criterion) {
+    let x = inputs();
+    let (point, s1) = (x.point, x.s1);
+    let (dalek_point, dalek_s1) = (x.dalek_point, x.dalek_s1);
+    let mul_lib = move || unsafe {
+        let mut out = mem::zeroed();
+        ristretto255_point_scalarmul(&mut out, &point, &s1);
+        out
+    };
+
+    assert_eq!(
+        encode(&mul_lib()),
+        (dalek_point * dalek_s1).compress().to_bytes()
+    );
+    compare(
+        c,
+        "scalar mul",
+        move |b| b.iter(|| mul_lib()),
+        move |b| b.iter(|| &dalek_point * &dalek_s1),
+    );
+}
+
+fn base_scalarmul(c: &mut Criterion) {
+    let x = inputs();
+    let (s1, dalek_s1) = (x.s1, x.dalek_s1);
+    let mul_lib = move || unsafe {
+        let mut out = mem::zeroed();
+        ristretto255_precomputed_scalarmul(&mut out, ristretto255_precomputed_base, &s1);
+        out
+    };
+
+    assert_eq!(
+        encode(&mul_lib()),
+        (&RISTRETTO_BASEPOINT_TABLE * &dalek_s1)
+            .compress()
+            .to_bytes()
+    );
+    compare(
+        c,
+        "base mul",
+        move |b| b.iter(|| mul_lib()),
+        move |b| b.iter(|| &RISTRETTO_BASEPOINT_TABLE * &dalek_s1),
+    );
+}
+
+/// The combination a signature verifier computes: s1*B + s2*P.
+fn double_scalarmul_verify(c: &mut Criterion) {
+    let x = inputs();
+    let (point, s1, s2) = (x.point, x.s1, x.s2);
+    let (dalek_point, dalek_s1, dalek_s2) = (x.dalek_point, x.dalek_s1, x.dalek_s2);
+    let mul_lib = move || unsafe {
+        let mut out = mem::zeroed();
+        ristretto255_base_double_scalarmul_non_secret(&mut out, &s1, &point, &s2);
+        out
+    };
+    let mul_dalek = move || {
+        RistrettoPoint::vartime_double_scalar_mul_basepoint(&dalek_s2, &dalek_point, &dalek_s1)
+    };
+
+    assert_eq!(encode(&mul_lib()), mul_dalek().compress().to_bytes());
+    compare(
+        c,
+        "double-scalar verify",
+        move |b| b.iter(|| mul_lib()),
+        move |b| b.iter(|| mul_dalek()),
+    );
+}
+
+/// Elligator on 64 uniform bytes, the map both libraries share.
+fn from_uniform_bytes(c: &mut Criterion) {
+    let hash = inputs().hash;
+    let map_lib = move || unsafe {
+        let mut out = mem::zeroed();
+        ristretto255_point_from_hash_uniform(&mut out, hash.as_ptr());
+        out
+    };
+
+    assert_eq!(
+        encode(&map_lib()),
+        RistrettoPoint::from_uniform_bytes(&hash)
+            .compress()
+            .to_bytes()
+    );
+    compare(
+        c,
+        "hash-to-group uniform bytes",
+        move |b| b.iter(|| map_lib()),
+        move |b| b.iter(|| RistrettoPoint::from_uniform_bytes(&hash)),
+    );
+}
+
+/// Hashing a message to the group with one SHA-512 and Elligator on its
+/// output, which is what dalek's hash_from_bytes does.  libristretto255's
+/// own hash_to_group uses expand_message_xmd, which is several SHA-512
+/// compressions, so it is not the equal-work counterpart.
+fn hash_to_group(c: &mut Criterion) {
+    let msg = inputs().hash;
+    let hash_lib = move || unsafe {
+        let mut digest = [0u8; 64];
+        let mut out = mem::zeroed();
+        ristretto255_sha512_hash(digest.as_mut_ptr(), msg.as_ptr(), msg.len());
+        ristretto255_point_from_hash_uniform(&mut out, digest.as_ptr());
+        out
+    };
+
+    assert_eq!(
+        encode(&hash_lib()),
+        RistrettoPoint::hash_from_bytes::<Sha512>(&msg)
+            .compress()
+            .to_bytes()
+    );
+    compare(
+        c,
+        "hash-to-group message",
+        move |b| b.iter(|| hash_lib()),
+        move |b| b.iter(|| RistrettoPoint::hash_from_bytes::<Sha512>(&msg)),
+    );
+}
+
+criterion_group!(
+    benches,
+    decode,
+    encode_point,
+    scalarmul,
+    base_scalarmul,
+    double_scalarmul_verify,
+    from_uniform_bytes,
+    hash_to_group
+);
+criterion_main!(benches);
@@ -1,4 +1,6 @@
 fn main() {
-    println!("cargo:rustc-link-search=../build/lib");
+    // Relative to this crate, so that crates outside the tests workspace
+    // can depend on it too
+    println!("cargo:rustc-link-search={}/../../build/lib", env!("CARGO_MANIFEST_DIR"));
     println!("cargo:rustc-link-lib=static=ristretto255");
 }
@@ -136,6 +136,83 @@ fn bindgen_test_layout_ristretto255_point_t() {
     );
 }
 
+/// A point prepared for adding to others, in projective Niels coordinates.
+#[repr(C)]
+#[derive(Debug, Copy, Clone)]
+pub struct ristretto255_point_cached_t {
+    /// @cond internal
+    pub a: gf_25519_t,
+    /// @cond internal
+    pub b: gf_25519_t,
+    /// @cond internal
+    pub c: gf_25519_t,
+    /// @cond internal
+    pub z: gf_25519_t,
+}
+
+#[test]
+fn bindgen_test_layout_ristretto255_point_cached_t() {
+    assert_eq!(
+        ::std::mem::size_of::<ristretto255_point_cached_t>(),
+        256usize,
+        concat!("Size of: ", stringify!(ristretto255_point_cached_t))
+    );
+}
+
+/// A cached point normalized to z=1, with ristretto255_point_cached_normalize.
+#[repr(C)]
+#[derive(Debug, Copy, Clone)]
+pub struct ristretto255_point_affine_cached_t {
+    /// @cond internal
+    pub a: gf_25519_t,
+    /// @cond internal
+    pub b: gf_25519_t,
+    /// @cond internal
+    pub c: gf_25519_t,
+}
+
+#[test]
+fn bindgen_test_layout_ristretto255_point_affine_cached_t() {
+    assert_eq!(
+        ::std::mem::size_of::<ristretto255_point_affine_cached_t>(),
+        192usize,
+        concat!("Size of: ", stringify!(ristretto255_point_affine_cached_t))
+    );
+}
+
+pub const RISTRETTO255_CACHED_NORMALIZE_BATCH: usize = 64;
+
+pub const RISTRETTO255_POINT_BLOCK_LANES: usize = 4;
+
+/// Four points, stored limb by limb: limb i of the x-coordinate of point j
+/// is x[i][j], and likewise for y, z and t.
+#[repr(C, align(32))]
+#[derive(Debug, Copy, Clone)]
+pub struct ristretto255_point_block_t {
+    /// @cond internal
+    pub x: [[ristretto_word_t; 4usize]; 5usize],
+    /// @cond internal
+    pub y: [[ristretto_word_t; 4usize]; 5usize],
+    /// @cond internal
+    pub z: [[ristretto_word_t; 4usize]; 5usize],
+    /// @cond internal
+    pub t: [[ristretto_word_t; 4usize]; 5usize],
+}
+
+#[test]
+fn bindgen_test_layout_ristretto255_point_block_t() {
+    assert_eq!(
+        ::std::mem::size_of::<ristretto255_point_block_t>(),
+        640usize,
+        concat!("Size of: ", stringify!(ristretto255_point_block_t))
+    );
+    assert_eq!(
+        ::std::mem::align_of::<ristretto255_point_block_t>(),
+        32usize,
+        concat!("Alignment of ", stringify!(ristretto255_point_block_t))
+    );
+}
+
 /// Precomputed table based on a point.  Can be trivial implementation.
 #[repr(C)]
 #[derive(Debug, Copy, Clone)]
@@ -147,6 +224,65 @@ extern "C" {
     pub static mut ristretto255_alignof_precomputed_s: usize;
 }
 
+/// Operations that can run in a caller-provided workspace.
+pub type ristretto255_workspace_op_t = u32;
+pub const RISTRETTO255_WS_PRECOMPUTE_BATCH: ristretto255_workspace_op_t = 1;
+pub const RISTRETTO255_WS_KEY_CACHE: ristretto255_workspace_op_t = 2;
+
+extern "C" {
+    /// @brief Size of the workspace that an operation needs for n inputs.
+    pub fn ristretto255_workspace_size(op: ristretto255_workspace_op_t, n: usize) -> usize;
+}
+
+/// Table of odd multiples of a point, for variable-time scalarmul.
+#[repr(C)]
+#[derive(Debug, Copy, Clone)]
+pub struct ristretto255_precomputed_wnaf_s {
+    _unused: [u8; 0],
+}
+extern "C" {
+    pub static mut ristretto255_sizeof_precomputed_wnaf_s: usize;
+}
+
+/// A bounded, thread-safe cache of decoded points and their wNAF tables.
+#[repr(C)]
+#[derive(Debug, Copy, Clone)]
+pub struct ristretto255_key_cache_t {
+    _unused: [u8; 0],
+}
+
+/// Kinds of table that a table file can hold.
+pub type ristretto255_table_kind_t = u32;
+pub const RISTRETTO255_TABLE_COMB: ristretto255_table_kind_t = 1;
+pub const RISTRETTO255_TABLE_WNAF: ristretto255_table_kind_t = 2;
+
+/// A table file mapped into memory.
+#[repr(C)]
+#[derive(Debug, Copy, Clone)]
+pub struct ristretto255_table_file_t {
+    pub file: *const u8,
+    pub file_len: usize,
+    pub table_bytes: usize,
+    pub kind: ristretto255_table_kind_t,
+    pub count: usize,
+}
+
+/// Counts of the primitive operations made by the calling thread.
+#[repr(C)]
+#[derive(Debug, Default, Copy, Clone)]
+pub struct ristretto255_stats_t {
+    pub gf_mul: u64,
+    pub gf_sqr: u64,
+    pub gf_mulw: u64,
+    pub gf_isr: u64,
+    pub gf4_mul: u64,
+    pub gf4_sqr: u64,
+    pub point_add: u64,
+    pub point_double: u64,
+    pub constant_time_lookup: u64,
+    pub bzero: u64,
+}
+
 /// Representation of an element of the scalar field.
 #[repr(C)]
 #[derive(Debug, Copy, Clone)]
@@ -179,6 +315,44 @@ fn bindgen_test_layout_ristretto255_scalar_t() {
     );
 }
 
+/// Incremental SHA-512 state.
+#[repr(C)]
+#[derive(Copy, Clone)]
+pub struct ristretto255_sha512_ctx_t {
+    /// @cond internal
+    pub state: [u64; 8usize],
+    pub block: [u8; 128usize],
+    pub bytes_processed: u64,
+}
+
+/// A domain separation tag, prepared once for any number of
+/// ristretto255_hash_* calls.
+#[repr(C)]
+#[derive(Copy, Clone)]
+pub struct ristretto255_hash_dst_t {
+    /// @cond internal
+    pub dst_prime: [u8; 256usize],
+    pub dst_prime_len: u16,
+}
+
+/// Incremental state of expand_message_xmd with SHA-512.
+#[repr(C)]
+#[derive(Copy, Clone)]
+pub struct ristretto255_hash_t {
+    /// @cond internal
+    pub sha: ristretto255_sha512_ctx_t,
+    pub dst: *const ristretto255_hash_dst_t,
+}
+
+#[test]
+fn bindgen_test_layout_ristretto255_hash_t() {
+    assert_eq!(
+        ::std::mem::size_of::<ristretto255_hash_t>(),
+        208usize,
+        concat!("Size of: ", stringify!(ristretto255_hash_t))
+    );
+}
+
 extern "C" {
     pub static mut ristretto255_scalar_one: ristretto255_scalar_t;
     pub static mut ristretto255_scalar_zero: ristretto255_scalar_t;
@@ -282,6 +456,43 @@ extern "C" {
     /// @param [out] out Will become equal to a.
     pub fn ristretto255_scalar_set_unsigned(out: *mut ristretto255_scalar_t, a: u64);
 
+    /// @brief Multiply two arrays of scalars elementwise: out[i] = a[i]*b[i].
+    /// Each output may be the same as the corresponding input.
+    /// @param [out] out The n products.
+    /// @param [in] a The n first factors.
+    /// @param [in] b The n second factors.
+    /// @param [in] n The number of scalars in each array.
+    pub fn ristretto255_scalar_mul_batch(
+        out: *mut ristretto255_scalar_t,
+        a: *const ristretto255_scalar_t,
+        b: *const ristretto255_scalar_t,
+        n: usize,
+    );
+
+    /// @brief Add two arrays of scalars elementwise: out[i] = a[i]+b[i].
+    /// @param [out] out The n sums.
+    /// @param [in] a The n first addends.
+    /// @param [in] b The n second addends.
+    /// @param [in] n The number of scalars in each array.
+    pub fn ristretto255_scalar_add_batch(
+        out: *mut ristretto255_scalar_t,
+        a: *const ristretto255_scalar_t,
+        b: *const ristretto255_scalar_t,
+        n: usize,
+    );
+
+    /// @brief Subtract two arrays of scalars elementwise: out[i] = a[i]-b[i].
+    /// @param [out] out The n differences.
+    /// @param [in] a The n minuends.
+    /// @param [in] b The n subtrahends.
+    /// @param [in] n The number of scalars in each array.
+    pub fn ristretto255_scalar_sub_batch(
+        out: *mut ristretto255_scalar_t,
+        a: *const ristretto255_scalar_t,
+        b: *const ristretto255_scalar_t,
+        n: usize,
+    );
+
     /// @brief Encode a point as a sequence of bytes.
     ///
     /// @param [out] ser The byte representation of the point.
@@ -364,6 +575,126 @@ extern "C" {
         a: *const ristretto255_point_t,
     );
 
+    /// @brief Prepare a point for repeated addition.
+    pub fn ristretto255_point_to_cached(
+        cached: *mut ristretto255_point_cached_t,
+        a: *const ristretto255_point_t,
+    );
+
+    /// @brief Add a cached point to a point.  The input and output points
+    /// can use the same memory.
+    pub fn ristretto255_point_add_cached(
+        sum: *mut ristretto255_point_t,
+        a: *const ristretto255_point_t,
+        b: *const ristretto255_point_cached_t,
+    );
+
+    /// @brief Subtract a cached point from a point.  The input and output
+    /// points can use the same memory.
+    pub fn ristretto255_point_sub_cached(
+        diff: *mut ristretto255_point_t,
+        a: *const ristretto255_point_t,
+        b: *const ristretto255_point_cached_t,
+    );
+
+    /// @brief Normalize n cached points to z=1, sharing an inversion between
+    /// up to RISTRETTO255_CACHED_NORMALIZE_BATCH of them.
+    pub fn ristretto255_point_cached_normalize(
+        out: *mut ristretto255_point_affine_cached_t,
+        in_: *const ristretto255_point_cached_t,
+        n: usize,
+    );
+
+    /// @brief Add a normalized cached point to a point.  The input and output
+    /// points can use the same memory.
+    pub fn ristretto255_point_add_affine_cached(
+        sum: *mut ristretto255_point_t,
+        a: *const ristretto255_point_t,
+        b: *const ristretto255_point_affine_cached_t,
+    );
+
+    /// @brief Subtract a normalized cached point from a point.  The input and
+    /// output points can use the same memory.
+    pub fn ristretto255_point_sub_affine_cached(
+        diff: *mut ristretto255_point_t,
+        a: *const ristretto255_point_t,
+        b: *const ristretto255_point_affine_cached_t,
+    );
+
+    /// @brief Sum n points, as a chain of ristretto255_point_add, using up
+    /// to the given number of threads.
+    pub fn ristretto255_point_sum(
+        sum: *mut ristretto255_point_t,
+        points: *const ristretto255_point_t,
+        n: usize,
+        threads: ::std::os::raw::c_uint,
+    );
+
+    /// @brief Decode n points and sum them, using up to the given number of
+    /// threads.  If any fails to decode, the sum is the identity and this
+    /// returns RISTRETTO_FAILURE.
+    pub fn ristretto255_point_decode_sum(
+        sum: *mut ristretto255_point_t,
+        ser: *const ::std::os::raw::c_uchar,
+        n: usize,
+        allow_identity: ristretto_bool_t,
+        threads: ::std::os::raw::c_uint,
+    ) -> ristretto_error_t;
+
+    /// @brief Pack n points into RISTRETTO255_POINT_BLOCKS(n) blocks.  Lanes
+    /// of the last block past n are set to the identity.
+    pub fn ristretto255_point_block_load(
+        blocks: *mut ristretto255_point_block_t,
+        points: *const ristretto255_point_t,
+        n: usize,
+    );
+
+    /// @brief Unpack the first n points of an array of blocks.
+    pub fn ristretto255_point_block_store(
+        points: *mut ristretto255_point_t,
+        blocks: *const ristretto255_point_block_t,
+        n: usize,
+    );
+
+    /// @brief Add n pairs of points held in blocks, as n calls to
+    /// ristretto255_point_add.  The inputs and output may alias.
+    pub fn ristretto255_point_block_add(
+        sum: *mut ristretto255_point_block_t,
+        a: *const ristretto255_point_block_t,
+        b: *const ristretto255_point_block_t,
+        n: usize,
+    );
+
+    /// @brief Double n points held in blocks, as n calls to
+    /// ristretto255_point_double.  The input and output may alias.
+    pub fn ristretto255_point_block_double(
+        two_a: *mut ristretto255_point_block_t,
+        a: *const ristretto255_point_block_t,
+        n: usize,
+    );
+
+    /// @brief Encode n points held in blocks, as n calls to
+    /// ristretto255_point_encode.  The inverse square roots are shared.
+    pub fn ristretto255_point_block_encode(
+        ser: *mut u8,
+        blocks: *const ristretto255_point_block_t,
+        n: usize,
+    );
+
+    /// @brief Decode n points into RISTRETTO255_POINT_BLOCKS(n) blocks, each
+    /// as ristretto255_point_decode.  Points which fail to decode, and lanes
+    /// past n, are set to the identity.
+    ///
+    /// @retval RISTRETTO_SUCCESS Every point decoded.
+    /// @retval RISTRETTO_FAILURE At least one point did not.
+    pub fn ristretto255_point_block_decode(
+        blocks: *mut ristretto255_point_block_t,
+        success: *mut ristretto_bool_t,
+        ser: *const u8,
+        n: usize,
+        allow_identity: ristretto_bool_t,
+    ) -> ristretto_error_t;
+
     /// @brief Multiply a base point by a scalar: scaled = scalar*base.
     ///
     /// @param [out] scaled The scaled point base*scalar
@@ -398,6 +729,30 @@ extern "C" {
         short_circuit: ristretto_bool_t,
     ) -> ristretto_error_t;
 
+    /// @brief Multiply n serialized base points by one scalar, each exactly as
+    /// ristretto255_direct_scalarmul without short-circuiting.  The scalar is
+    /// recoded once, several bases are multiplied in an interleaved pipeline,
+    /// and the decodes and encodes share inverse square roots.
+    ///
+    /// @param [out] scaled n encodings of scalar*base.  As for the single-point
+    /// function, a base that fails to decode is replaced by the generator.
+    /// @param [out] success Per base, RISTRETTO_TRUE if it decoded.
+    /// @param [in] bases n encoded points to be scaled.
+    /// @param [in] scalar The scalar to multiply by.
+    /// @param [in] n The number of bases.
+    /// @param [in] allow_identity Allow the inputs to be the identity.
+    ///
+    /// @retval RISTRETTO_SUCCESS Every base decoded.
+    /// @retval RISTRETTO_FAILURE At least one base did not.
+    pub fn ristretto255_direct_scalarmul_fanout(
+        scaled: *mut u8,
+        success: *mut ristretto_bool_t,
+        bases: *const u8,
+        scalar: *const ristretto255_scalar_t,
+        n: usize,
+        allow_identity: ristretto_bool_t,
+    ) -> ristretto_error_t;
+
     /// @brief Precompute a table for fast scalar multiplication.
     /// Some implementations do not include precomputed points; for
     /// those implementations, this implementation simply copies the
@@ -410,6 +765,25 @@ extern "C" {
         b: *const ristretto255_point_t,
     );
 
+    /// @brief Precompute tables for many points, as n calls to
+    /// ristretto255_precompute, sharing field inversions and splitting
+    /// the points across threads.
+    pub fn ristretto255_precompute_batch(
+        tables: *mut ristretto255_precomputed_s,
+        bases: *const ristretto255_point_t,
+        n: usize,
+        threads: u32,
+    );
+
+    /// @brief As ristretto255_precompute_batch on one thread, but with a
+    /// single field inversion, using a caller-provided workspace.
+    pub fn ristretto255_precompute_batch_ws(
+        tables: *mut ristretto255_precomputed_s,
+        bases: *const ristretto255_point_t,
+        n: usize,
+        workspace: *mut ::std::os::raw::c_void,
+    );
+
     /// @brief Multiply a precomputed base point by a scalar:
     /// scaled = scalar*base.
     /// Some implementations do not include precomputed points; for
@@ -444,6 +818,50 @@ extern "C" {
         scalar2: *const ristretto255_scalar_t,
     );
 
+    /// @brief Multiply a base point by a public scalar: scaled = scalar*base.
+    ///
+    /// Otherwise equivalent to ristretto255_point_scalarmul, but faster at the
+    /// expense of being variable time.
+    ///
+    /// @param [out] scaled The scaled point base*scalar.  It may be the same
+    /// as the base.
+    /// @param [in] base The point to be scaled.
+    /// @param [in] scalar The scalar to multiply by.
+    ///
+    /// @warning: This function takes variable time, and may leak the scalar
+    /// used.
+    pub fn ristretto255_point_scalarmul_non_secret(
+        scaled: *mut ristretto255_point_t,
+        base: *const ristretto255_point_t,
+        scalar: *const ristretto255_scalar_t,
+    );
+
+    /// @brief Precompute a table of odd multiples of a point, for repeated
+    /// variable-time multiplication of that point by public scalars.
+    pub fn ristretto255_precompute_wnaf(
+        table: *mut ristretto255_precomputed_wnaf_s,
+        base: *const ristretto255_point_t,
+    );
+
+    /// @brief Multiply a point by a public scalar, using its wNAF table.
+    ///
+    /// @warning: This function takes variable time, and may leak the scalar
+    /// used.
+    pub fn ristretto255_precomputed_wnaf_scalarmul_non_secret(
+        scaled: *mut ristretto255_point_t,
+        base: *const ristretto255_precomputed_wnaf_s,
+        scalar: *const ristretto255_scalar_t,
+    );
+
+    /// @brief As ristretto255_base_double_scalarmul_non_secret, but using
+    /// base2's wNAF table.
+    pub fn ristretto255_precomputed_wnaf_base_double_scalarmul_non_secret(
+        combo: *mut ristretto255_point_t,
+        scalar1: *const ristretto255_scalar_t,
+        base2: *const ristretto255_precomputed_wnaf_s,
+        scalar2: *const ristretto255_scalar_t,
+    );
+
     /// Multiply one base point by two scalars:
     ///
     /// a1 = scalar1 * base
@@ -465,6 +883,59 @@ extern "C" {
         scalar2: *const ristretto255_scalar_t,
     );
 
+    /// Multiply one base point by n scalars: scaled[i] = scalars[i] * base.
+    ///
+    /// Equivalent to n calls to ristretto255_point_scalarmul, but the doublings
+    /// of the base are computed once and shared, so it is faster for n > 1.
+    ///
+    /// @param [out] scaled The n multiples.  One of them may be the base.
+    /// @param [in] base The point to be scaled.
+    /// @param [in] scalars The n scalars to multiply by.
+    /// @param [in] n The number of scalars.
+    pub fn ristretto255_point_scalarmul_multiples(
+        scaled: *mut ristretto255_point_t,
+        base: *const ristretto255_point_t,
+        scalars: *const ristretto255_scalar_t,
+        n: usize,
+    );
+
+    /// @brief Multiply one base point by n public scalars:
+    /// scaled[i] = scalars[i] * base.
+    ///
+    /// Otherwise equivalent to ristretto255_point_scalarmul_multiples, but
+    /// faster at the expense of being variable time.
+    ///
+    /// @param [out] scaled The n multiples.  One of them may be the base.
+    /// @param [in] base The point to be scaled.
+    /// @param [in] scalars The n scalars to multiply by.
+    /// @param [in] n The number of scalars.
+    ///
+    /// @warning: This function takes variable time, and may leak the scalars
+    /// used.
+    pub fn ristretto255_point_scalarmul_multiples_non_secret(
+        scaled: *mut ristretto255_point_t,
+        base: *const ristretto255_point_t,
+        scalars: *const ristretto255_scalar_t,
+        n: usize,
+    );
+
+    /// @brief Multiply the base point by a public scalar:
+    /// scaled = scalar*ristretto255_point_base.
+    ///
+    /// Otherwise equivalent to ristretto255_precomputed_scalarmul with
+    /// ristretto255_precomputed_base, but faster at the expense of being
+    /// variable time.
+    ///
+    /// @param [out] scaled The scaled point scalar*base.
+    /// @param [in] scalar The scalar to multiply by.
+    ///
+    /// @warning: This function takes variable time, and may leak the scalar
+    /// used.
+    pub fn ristretto255_base_scalarmul_non_secret(
+        scaled: *mut ristretto255_point_t,
+        scalar: *const ristretto255_scalar_t,
+    );
+
     /// @brief Multiply two base points by two scalars:
     /// scaled = scalar1*ristretto255_point_base + scalar2*base2.
     ///
@@ -585,6 +1056,20 @@ extern "C" {
         hashed_data: *const ::std::os::raw::c_uchar,
     );
 
+    /// @brief Hash many inputs to the curve at once.
+    ///
+    /// Equivalent to n calls to ristretto255_point_from_hash_uniform.
+    ///
+    /// @param [in] hashed_data n consecutive outputs of some hash function,
+    /// each 2*RISTRETTO255_HASH_BYTES long.
+    /// @param [out] pts The n points.
+    /// @param [in] n The number of inputs.
+    pub fn ristretto255_point_from_hash_uniform_batch(
+        pts: *mut ristretto255_point_t,
+        hashed_data: *const ::std::os::raw::c_uchar,
+        n: usize,
+    );
+
     /// @brief Inverse of elligator-like hash to curve.
     ///
     /// This function writes to the buffer, to make it so that
@@ -639,6 +1124,250 @@ extern "C" {
         which: u32,
     ) -> ristretto_error_t;
 
+    /// @brief Every Elligator inverse of a point at once.
+    ///
+    /// @return A mask with bit "which" set if recovered_hashes[which] is a
+    /// preimage.
+    pub fn ristretto255_invert_elligator_nonuniform_all(
+        recovered_hashes: *mut [::std::os::raw::c_uchar; 32usize],
+        pt: *const ristretto255_point_t,
+    ) -> u32;
+
+    /// @brief Every uniform Elligator inverse of a point at once.
+    ///
+    /// @return A mask with bit "which" set if recovered_hashes[which] is a
+    /// preimage.
+    pub fn ristretto255_invert_elligator_uniform_all(
+        recovered_hashes: *mut [::std::os::raw::c_uchar; 64usize],
+        pt: *const ristretto255_point_t,
+        partial_hash: *const ::std::os::raw::c_uchar,
+    ) -> u32;
+
+    /// @brief Uniform Elligator inverses of n points, each exactly as
+    /// ristretto255_invert_elligator_uniform with its own hint.
+    ///
+    /// @retval RISTRETTO_SUCCESS Every inverse succeeded.
+    /// @retval RISTRETTO_FAILURE At least one inverse failed.
+    pub fn ristretto255_invert_elligator_uniform_batch(
+        recovered_hashes: *mut ::std::os::raw::c_uchar,
+        success: *mut ristretto_bool_t,
+        pts: *const ristretto255_point_t,
+        hints: *const ::std::os::raw::c_uchar,
+        n: usize,
+    ) -> ristretto_error_t;
+
+    /// @brief Hash a message with SHA-512 in one call.
+    ///
+    /// @param [out] out The hash.
+    /// @param [in] message The message.
+    /// @param [in] message_len The length of the message in bytes.
+    pub fn ristretto255_sha512_hash(out: *mut u8, message: *const u8, message_len: usize);
+
+    /// @brief Prepare a domain separation tag.
+    ///
+    /// @param [out] dst The prepared tag.
+    /// @param [in] tag The domain separation tag.
+    /// @param [in] tag_len The length of the tag in bytes.
+    pub fn ristretto255_hash_dst_init(
+        dst: *mut ristretto255_hash_dst_t,
+        tag: *const u8,
+        tag_len: usize,
+    );
+
+    /// @brief Start hashing a message with expand_message_xmd (RFC 9380) and SHA-512.
+    ///
+    /// @param [out] ctx The hash context.
+    /// @param [in] dst The prepared domain separation tag.
+    pub fn ristretto255_hash_init(ctx: *mut ristretto255_hash_t, dst: *const ristretto255_hash_dst_t);
+
+    /// @brief Absorb part of a message.
+    ///
+    /// @param [inout] ctx The hash context.
+    /// @param [in] message The message fragment.
+    /// @param [in] message_len The length of the fragment in bytes.
+    pub fn ristretto255_hash_update(ctx: *mut ristretto255_hash_t, message: *const u8, message_len: usize);
+
+    /// @brief Finish expand_message_xmd, producing out_len uniform bytes.
+    ///
+    /// @param [inout] ctx The hash context.
+    /// @param [out] out The uniform bytes.
+    /// @param [in] out_len The number of bytes to produce, at most 255*64.
+    ///
+    /// @retval RISTRETTO_SUCCESS The bytes were produced.
+    /// @retval RISTRETTO_FAILURE out_len is too long.
+    pub fn ristretto255_hash_final(
+        ctx: *mut ristretto255_hash_t,
+        out: *mut u8,
+        out_len: usize,
+    ) -> ristretto_error_t;
+
+    /// @brief Hash a message to a group element in one call.
+    ///
+    /// @param [out] pt The resulting point.
+    /// @param [in] message The message.
+    /// @param [in] message_len The length of the message in bytes.
+    /// @param [in] dst The prepared domain separation tag.
+    pub fn ristretto255_hash_to_group(
+        pt: *mut ristretto255_point_t,
+        message: *const u8,
+        message_len: usize,
+        dst: *const ristretto255_hash_dst_t,
+    );
+
+    /// @brief Hash a message to a scalar in one call.
+    ///
+    /// @param [out] out The resulting scalar.
+    /// @param [in] message The message.
+    /// @param [in] message_len The length of the message in bytes.
+    /// @param [in] dst The prepared domain separation tag.
+    pub fn ristretto255_hash_to_scalar(
+        out: *mut ristretto255_scalar_t,
+        message: *const u8,
+        message_len: usize,
+        dst: *const ristretto255_hash_dst_t,
+    );
+
+    /// @brief Hash n messages to group elements, exactly as n calls to
+    /// ristretto255_hash_to_group with the same DST.
+    pub fn ristretto255_hash_to_group_batch(
+        pts: *mut ristretto255_point_t,
+        messages: *const *const u8,
+        message_lens: *const usize,
+        n: usize,
+        dst: *const ristretto255_hash_dst_t,
+    );
+
+    /// @brief Hash n messages to scalars, exactly as n calls to
+    /// ristretto255_hash_to_scalar with the same DST.
+    pub fn ristretto255_hash_to_scalar_batch(
+        out: *mut ristretto255_scalar_t,
+        messages: *const *const u8,
+        message_lens: *const usize,
+        n: usize,
+        dst: *const ristretto255_hash_dst_t,
+    );
+
+    /// @brief Size of a table file holding count tables of the given kind.
+    pub fn ristretto255_table_file_bytes(kind: ristretto255_table_kind_t, count: usize) -> usize;
+
+    /// @brief Serialize comb tables into a table file image.
+    pub fn ristretto255_table_file_encode_comb(
+        out: *mut u8,
+        tables: *const ristretto255_precomputed_s,
+        count: usize,
+    );
+
+    /// @brief Serialize wNAF tables into a table file image.
+    pub fn ristretto255_table_file_encode_wnaf(
+        out: *mut u8,
+        tables: *const ristretto255_precomputed_wnaf_s,
+        count: usize,
+    );
+
+    /// @brief Check a table file image and view it in place.
+    pub fn ristretto255_table_file_view(
+        view: *mut ristretto255_table_file_t,
+        file: *const u8,
+        file_len: usize,
+        kind: ristretto255_table_kind_t,
+        verify: ristretto_bool_t,
+    ) -> ristretto_error_t;
+
+    /// @brief Map a table file read-only and view it in place.
+    pub fn ristretto255_table_file_map(
+        map: *mut ristretto255_table_file_t,
+        path: *const ::std::os::raw::c_char,
+        kind: ristretto255_table_kind_t,
+        verify: ristretto_bool_t,
+    ) -> ristretto_error_t;
+
+    /// Unmap a table file from ristretto255_table_file_map.
+    pub fn ristretto255_table_file_unmap(map: *mut ristretto255_table_file_t);
+
+    /// @brief The i'th comb table in a table file, or NULL.
+    pub fn ristretto255_table_file_comb(
+        map: *const ristretto255_table_file_t,
+        i: usize,
+    ) -> *const ristretto255_precomputed_s;
+
+    /// @brief The i'th wNAF table in a table file, or NULL.
+    pub fn ristretto255_table_file_wnaf(
+        map: *const ristretto255_table_file_t,
+        i: usize,
+    ) -> *const ristretto255_precomputed_wnaf_s;
+
+    /// @brief Create a key cache, or return NULL.
+    pub fn ristretto255_key_cache_new(capacity: usize) -> *mut ristretto255_key_cache_t;
+
+    /// Destroy a key cache.  It must not be in use by any thread.
+    pub fn ristretto255_key_cache_free(cache: *mut ristretto255_key_cache_t);
+
+    /// @brief Count the lookups the cache has answered and missed.
+    pub fn ristretto255_key_cache_stats(
+        cache: *mut ristretto255_key_cache_t,
+        hits: *mut u64,
+        misses: *mut u64,
+    );
+
+    /// @brief As ristretto255_point_decode, through the cache.
+    pub fn ristretto255_key_cache_decode(
+        point: *mut ristretto255_point_t,
+        cache: *mut ristretto255_key_cache_t,
+        ser: *const u8,
+        allow_identity: ristretto_bool_t,
+    ) -> ristretto_error_t;
+
+    /// @brief Decode base through the cache and multiply it by a public
+    /// scalar, using its cached table.
+    pub fn ristretto255_key_cache_scalarmul_non_secret(
+        scaled: *mut ristretto255_point_t,
+        cache: *mut ristretto255_key_cache_t,
+        base: *const u8,
+        scalar: *const ristretto255_scalar_t,
+        allow_identity: ristretto_bool_t,
+    ) -> ristretto_error_t;
+
+    /// @brief Decode base2 through the cache and compute
+    /// combo = scalar1*base + scalar2*base2.
+    pub fn ristretto255_key_cache_base_double_scalarmul_non_secret(
+        combo: *mut ristretto255_point_t,
+        cache: *mut ristretto255_key_cache_t,
+        scalar1: *const ristretto255_scalar_t,
+        base2: *const u8,
+        scalar2: *const ristretto255_scalar_t,
+        allow_identity: ristretto_bool_t,
+    ) -> ristretto_error_t;
+
+    /// @brief As ristretto255_key_cache_scalarmul_non_secret, using a
+    /// workspace instead of allocating.
+    pub fn ristretto255_key_cache_scalarmul_non_secret_ws(
+        scaled: *mut ristretto255_point_t,
+        cache: *mut ristretto255_key_cache_t,
+        base: *const u8,
+        scalar: *const ristretto255_scalar_t,
+        allow_identity: ristretto_bool_t,
+        workspace: *mut ::std::os::raw::c_void,
+    ) -> ristretto_error_t;
+
+    /// @brief As ristretto255_key_cache_base_double_scalarmul_non_secret,
+    /// using a workspace instead of allocating.
+    pub fn ristretto255_key_cache_base_double_scalarmul_non_secret_ws(
+        combo: *mut ristretto255_point_t,
+        cache: *mut ristretto255_key_cache_t,
+        scalar1: *const ristretto255_scalar_t,
+        base2: *const u8,
+        scalar2: *const ristretto255_scalar_t,
+        allow_identity: ristretto_bool_t,
+        workspace: *mut ::std::os::raw::c_void,
+    ) -> ristretto_error_t;
+
+    /// @brief Copy the calling thread's operation counts.  Returns false,
+    /// with all counts zero, unless built with RISTRETTO_STATS.
+    pub fn ristretto255_stats_snapshot(stats: *mut ristretto255_stats_t) -> ristretto_bool_t;
+
+    /// Zero the calling thread's operation counts.
+    pub fn ristretto255_stats_reset();
+
     /// Securely erase a scalar.
     pub fn ristretto255_scalar_destroy(scalar: *mut ristretto255_scalar_t);
 
@@ -60,9 +60,12 @@ pub mod vectors;
 #[cfg(test)]
 #[allow(non_snake_case)]
 mod test {
-    use rand::OsRng;
+    use rand::{OsRng, Rng};
 
-    use ristretto::{CompressedRistretto, RistrettoPoint};
+    use ristretto::{
+        op_stats, CachedPoint, CompressedRistretto, KeyCache, PointBlocks, PrecomputedTables,
+        RistrettoPoint, WnafTableFile,
+    };
     use scalar::Scalar;
 
     #[test]
@@ -117,4 +120,359 @@ mod test {
             assert_eq!(P, Q);
         }
     }
+
+    #[test]
+    fn compressed_mul_batch_matches_scalarmul() {
+        let mut rng = OsRng::new().unwrap();
+        let B = RistrettoPoint::basepoint();
+        let s = Scalar::random(&mut rng);
+
+        // Not a multiple of the batch size, with the identity and a non-point
+        let mut bases: Vec<CompressedRistretto> =
+            (0..21).map(|_| (B * Scalar::random(&mut rng)).compress()).collect();
+        bases[3] = CompressedRistretto::identity();
+        bases[11] = CompressedRistretto([0xff; 32]);
+
+        let scaled = CompressedRistretto::mul_batch(&bases, &s);
+        for (base, result) in bases.iter().zip(scaled.iter()) {
+            let expected = base.decompress().map(|P| (P * s).compress());
+            assert_eq!(*result, expected);
+        }
+    }
+
+    #[test]
+    fn mul_non_secret_matches_scalarmul() {
+        let mut rng = OsRng::new().unwrap();
+
+        for _ in 0..32 {
+            let P = RistrettoPoint::basepoint() * Scalar::random(&mut rng);
+            let s = Scalar::random(&mut rng);
+            assert_eq!(P.mul_non_secret(&s), P * s);
+        }
+        let P = RistrettoPoint::basepoint();
+        assert_eq!(P.mul_non_secret(&Scalar::from(0u64)), RistrettoPoint::identity());
+        assert_eq!(P.mul_non_secret(&Scalar::from(1u64)), P);
+    }
+
+    #[test]
+    fn basepoint_mul_non_secret_matches_scalarmul() {
+        let mut rng = OsRng::new().unwrap();
+        let B = RistrettoPoint::basepoint();
+
+        for _ in 0..32 {
+            let s = Scalar::random(&mut rng);
+            assert_eq!(RistrettoPoint::basepoint_mul_non_secret(&s), B * s);
+        }
+        assert_eq!(RistrettoPoint::basepoint_mul_non_secret(&Scalar::from(0u64)), RistrettoPoint::identity());
+        assert_eq!(RistrettoPoint::basepoint_mul_non_secret(&Scalar::from(1u64)), B);
+    }
+
+    #[test]
+    fn key_cache_matches_uncached() {
+        let mut rng = OsRng::new().unwrap();
+        let B = RistrettoPoint::basepoint();
+        let keys: Vec<_> = (0..24).map(|_| (B * Scalar::random(&mut rng)).compress()).collect();
+        let cache = KeyCache::new(16);
+
+        for round in 0..3 {
+            for A in &keys {
+                let (a, b) = (Scalar::random(&mut rng), Scalar::random(&mut rng));
+                let expected = B * a + A.decompress().unwrap() * b;
+                assert_eq!(cache.basepoint_double_mul_non_secret(&a, A, &b), Some(expected));
+                assert_eq!(cache.decompress(A), A.decompress(), "round {}", round);
+            }
+        }
+
+        let (hits, misses) = cache.stats();
+        assert_eq!(hits + misses, 3 * 2 * keys.len() as u64);
+        assert!(hits > 0 && misses >= keys.len() as u64);
+        assert!(cache.decompress(&CompressedRistretto([0xff; 32])).is_none());
+
+        // A zero second scalar leaves a*B, on a miss and on a hit
+        let a = Scalar::random(&mut rng);
+        for _ in 0..2 {
+            assert_eq!(cache.basepoint_double_mul_non_secret(&a, &keys[0], &Scalar::from(0u64)), Some(B * a));
+        }
+    }
+
+    #[test]
+    fn precompute_batch_matches_scalarmul() {
+        let mut rng = OsRng::new().unwrap();
+        let mut points: Vec<_> = (0..19)
+            .map(|_| RistrettoPoint::basepoint() * Scalar::random(&mut rng))
+            .collect();
+        points[3] = RistrettoPoint::identity();
+
+        for &threads in &[1, 3] {
+            let tables = PrecomputedTables::new(&points, threads);
+            for (i, P) in points.iter().enumerate() {
+                let s = Scalar::random(&mut rng);
+                assert_eq!(tables.mul(i, &s), *P * s);
+            }
+        }
+
+        let tables = PrecomputedTables::new_single_inversion(&points);
+        for (i, P) in points.iter().enumerate() {
+            let s = Scalar::random(&mut rng);
+            assert_eq!(tables.mul(i, &s), *P * s);
+        }
+    }
+
+    #[test]
+    fn point_blocks_match_single() {
+        let mut rng = OsRng::new().unwrap();
+        let points: Vec<_> = (0..11)
+            .map(|_| RistrettoPoint::basepoint() * Scalar::random(&mut rng))
+            .collect();
+        let mut others: Vec<_> = (0..11)
+            .map(|_| RistrettoPoint::basepoint() * Scalar::random(&mut rng))
+            .collect();
+        others[5] = RistrettoPoint::identity();
+
+        let mut sums = PointBlocks::new(&points).add(&PointBlocks::new(&others));
+        sums.double();
+        let expected: Vec<_> = (0..points.len())
+            .map(|i| (points[i] + others[i]) + (points[i] + others[i]))
+            .collect();
+        assert_eq!(sums.to_points(), expected);
+
+        let mut compressed = sums.compress();
+        for (c, P) in compressed.iter().zip(expected.iter()) {
+            assert_eq!(*c, P.compress());
+        }
+
+        compressed[7] = CompressedRistretto([0xff; 32]);
+        let (decoded, success) = PointBlocks::decompress(&compressed);
+        for (i, P) in decoded.to_points().iter().enumerate() {
+            assert_eq!(success[i], i != 7);
+            assert_eq!(*P, if i == 7 { RistrettoPoint::identity() } else { expected[i] });
+        }
+    }
+
+    #[test]
+    fn cached_points_match_add() {
+        let mut rng = OsRng::new().unwrap();
+        // More than one normalization batch, with the identity in the last
+        let mut points: Vec<_> = (0..70)
+            .map(|_| RistrettoPoint::basepoint() * Scalar::random(&mut rng))
+            .collect();
+        points[69] = RistrettoPoint::identity();
+        let P = RistrettoPoint::basepoint() * Scalar::random(&mut rng);
+
+        let cached: Vec<_> = points.iter().map(CachedPoint::new).collect();
+        let affine = CachedPoint::normalize(&cached);
+        for (i, Q) in points.iter().enumerate() {
+            assert_eq!(cached[i].add_to(&P), P + *Q);
+            assert_eq!(cached[i].sub_from(&P), P - *Q);
+            assert_eq!(affine[i].add_to(&P), P + *Q);
+            assert_eq!(affine[i].sub_from(&P), P - *Q);
+        }
+    }
+
+    #[test]
+    fn point_sums_match_add() {
+        let mut rng = OsRng::new().unwrap();
+        let points: Vec<_> = (0..600)
+            .map(|_| RistrettoPoint::basepoint() * Scalar::random(&mut rng))
+            .collect();
+        let mut compressed: Vec<_> = points.iter().map(|P| P.compress()).collect();
+
+        for &n in &[0, 1, 5, 600] {
+            let expected = points[..n].iter().fold(RistrettoPoint::identity(), |acc, P| acc + *P);
+            for &threads in &[1, 4] {
+                assert_eq!(RistrettoPoint::sum(&points[..n], threads), expected);
+                assert_eq!(CompressedRistretto::decompress_sum(&compressed[..n], threads), Some(expected));
+            }
+        }
+
+        compressed[300] = CompressedRistretto([0xff; 32]);
+        assert_eq!(CompressedRistretto::decompress_sum(&compressed, 4), None);
+    }
+
+    #[test]
+    fn wnaf_table_file_roundtrip() {
+        let mut rng = OsRng::new().unwrap();
+        let points: Vec<_> = (0..8)
+            .map(|_| RistrettoPoint::basepoint() * Scalar::random(&mut rng))
+            .collect();
+        let path = std::env::temp_dir().join(format!("ristretto255-wnaf-{}.tbl", std::process::id()));
+
+        WnafTableFile::write(&path, &points).unwrap();
+        let file = WnafTableFile::map(&path, true).unwrap();
+        assert_eq!(file.len(), points.len());
+
+        for (i, P) in points.iter().enumerate() {
+            let s = Scalar::random(&mut rng);
+            assert_eq!(file.mul_non_secret(i, &s), Some(*P * s));
+        }
+        assert!(file.mul_non_secret(points.len(), &Scalar::from(1u64)).is_none());
+
+        drop(file);
+        let mut bytes = std::fs::read(&path).unwrap();
+        let last = bytes.len() - 1;
+        bytes[last] ^= 1;
+        std::fs::write(&path, &bytes).unwrap();
+        assert!(WnafTableFile::map(&path, true).is_none());
+        assert!(WnafTableFile::map(&path, false).is_some());
+        std::fs::remove_file(&path).unwrap();
+    }
+
+    #[test]
+    fn table_file_from_other_config_is_rejected() {
+        use sha2::{Digest, Sha512};
+
+        let path = std::env::temp_dir().join(format!("ristretto255-config-{}.tbl", std::process::id()));
+        WnafTableFile::write(&path, &[RistrettoPoint::basepoint()]).unwrap();
+        let mut bytes = std::fs::read(&path).unwrap();
+
+        // Rewrite the digest over the first 64 header bytes and the payload
+        let redigest = |bytes: &mut Vec<u8>| {
+            let mut digested = bytes[..64].to_vec();
+            digested.extend_from_slice(&bytes[128..]);
+            let digest = Sha512::digest(&digested);
+            bytes[64..128].copy_from_slice(&digest);
+        };
+        redigest(&mut bytes);
+        std::fs::write(&path, &bytes).unwrap();
+        assert!(WnafTableFile::map(&path, true).is_some());
+
+        // As written by a build with another COMBS_N: a consistent file
+        // whose config tag, at byte 40, differs from this build's
+        bytes[40] ^= 1;
+        redigest(&mut bytes);
+        std::fs::write(&path, &bytes).unwrap();
+        assert!(WnafTableFile::map(&path, true).is_none());
+        assert!(WnafTableFile::map(&path, false).is_none());
+        std::fs::remove_file(&path).unwrap();
+    }
+
+    #[test]
+    fn mul_multiples_matches_scalarmul() {
+        let mut rng = OsRng::new().unwrap();
+        let P = RistrettoPoint::basepoint() * Scalar::random(&mut rng);
+
+        let mut scalars: Vec<Scalar> = (0..9).map(|_| Scalar::random(&mut rng)).collect();
+        scalars[0] = Scalar::from(0u64);
+        scalars[1] = Scalar::from(1u64);
+
+        let multiples = P.mul_multiples(&scalars);
+        let multiples_vartime = P.mul_multiples_non_secret(&scalars);
+        for i in 0..scalars.len() {
+            assert_eq!(multiples[i], P * scalars[i]);
+            assert_eq!(multiples_vartime[i], P * scalars[i]);
+        }
+    }
+
+    #[test]
+    fn scalar_batch_matches_elementwise() {
+        let mut rng = OsRng::new().unwrap();
+
+        // Odd length so that the non-vector tail is exercised too
+        let a: Vec<Scalar> = (0..11)
+            .map(|_| Scalar::random(&mut rng) * Scalar::random(&mut rng) * Scalar::random(&mut rng))
+            .collect();
+        let b: Vec<Scalar> = (0..11)
+            .map(|_| Scalar::random(&mut rng) * Scalar::random(&mut rng) * Scalar::random(&mut rng))
+            .collect();
+
+        let products = Scalar::mul_batch(&a, &b);
+        let sums = Scalar::add_batch(&a, &b);
+        let differences = Scalar::sub_batch(&a, &b);
+
+        for i in 0..a.len() {
+            assert_eq!(products[i], a[i] * b[i]);
+            assert_eq!(sums[i], a[i] + b[i]);
+            assert_eq!(differences[i], a[i] - b[i]);
+        }
+    }
+
+    #[test]
+    fn hash_batch_matches_single() {
+        let mut rng = OsRng::new().unwrap();
+
+        // Long enough to cover a full vector block and a ragged tail
+        let mut inputs = vec![[0u8; 64]; 11];
+        for input in inputs.iter_mut() {
+            rng.fill(&mut input[..]);
+        }
+
+        let points = RistrettoPoint::from_uniform_bytes_batch(&inputs);
+        for (input, point) in inputs.iter().zip(points.iter()) {
+            assert_eq!(RistrettoPoint::from_uniform_bytes(input), *point);
+        }
+    }
+
+    #[test]
+    fn elligator_inverse_batch_matches_single() {
+        let mut rng = OsRng::new().unwrap();
+
+        let mut points = Vec::new();
+        let mut partial_hashes = vec![[0u8; 32]; 19];
+        let mut hints = vec![0u8; 19];
+        for partial_hash in partial_hashes.iter_mut() {
+            let mut input = [0u8; 64];
+            rng.fill(&mut input[..]);
+            points.push(RistrettoPoint::from_uniform_bytes(&input));
+            rng.fill(&mut partial_hash[..]);
+        }
+        rng.fill(&mut hints[..]);
+
+        let encodings = RistrettoPoint::to_uniform_bytes_batch(&points, &partial_hashes, &hints);
+        for i in 0..points.len() {
+            let single = points[i].to_uniform_bytes(&partial_hashes[i], hints[i] as u32);
+            assert_eq!(single.map(|e| e.to_vec()), encodings[i].map(|e| e.to_vec()));
+            if let Some(encoding) = encodings[i] {
+                assert_eq!(RistrettoPoint::from_uniform_bytes(&encoding), points[i]);
+            }
+        }
+    }
+
+    #[test]
+    fn elligator_inverse_all_matches_each_which() {
+        let mut rng = OsRng::new().unwrap();
+
+        for _ in 0..16 {
+            let mut input = [0u8; 64];
+            rng.fill(&mut input[..]);
+            let point = RistrettoPoint::from_uniform_bytes(&input);
+            let mut partial_hash = [0u8; 32];
+            partial_hash.copy_from_slice(&input[32..]);
+
+            let (mask, encodings) = point.to_uniform_bytes_all(&partial_hash);
+            for (which, encoding) in encodings.iter().enumerate() {
+                let single = point.to_uniform_bytes(&partial_hash, which as u32);
+                assert_eq!(single.is_some(), mask >> which & 1 == 1);
+                if let Some(single) = single {
+                    assert_eq!(&single[..], &encoding[..]);
+                    assert_eq!(RistrettoPoint::from_uniform_bytes(encoding), point);
+                }
+            }
+        }
+    }
+
+    #[test]
+    fn op_stats_count_per_thread() {
+        let P = RistrettoPoint::basepoint() * Scalar::from(7u64);
+        let encoding = P.compress();
+
+        op_stats(true);
+        let stats = match op_stats(false) {
+            Some(stats) => stats,
+            None => return, // not a RISTRETTO_STATS build
+        };
+        assert_eq!(stats.gf_mul + stats.gf_isr + stats.point_add, 0);
+
+        assert_eq!(encoding.decompress(), Some(P));
+        let _ = P * Scalar::from(3u64);
+        let stats = op_stats(true).unwrap();
+        assert_eq!(stats.gf_isr, 1);
+        assert!(stats.gf_mul > 0 && stats.point_double > 0 && stats.constant_time_lookup > 0);
+
+        let other = ::std::thread::spawn(move || {
+            let _ = encoding.decompress();
+            op_stats(false).unwrap()
+        });
+        assert_eq!(other.join().unwrap().gf_isr, 1);
+        assert_eq!(op_stats(false).unwrap().gf_isr, 0);
+    }
 }
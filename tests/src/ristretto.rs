@@ -1,9 +1,13 @@
 use curve25519_dalek;
 use libristretto255_sys::*;
 use std::{
+    alloc::{self, Layout},
+    ffi::CString,
     fmt::{self, Debug},
-    mem,
+    fs, io, mem,
     ops::{Add, Mul, Neg, Sub},
+    os::unix::ffi::OsStrExt,
+    path::Path,
 };
 
 use constants;
@@ -12,6 +16,7 @@ use util::{convert_bool, convert_result};
 
 /// Compressed Ristretto255 point
 #[derive(Copy, Clone, Eq, PartialEq)]
+#[repr(transparent)]
 pub struct CompressedRistretto(pub [u8; 32]);
 
 impl CompressedRistretto {
@@ -45,6 +50,47 @@ impl CompressedRistretto {
 
         convert_result(point.into(), error).ok()
     }
+
+    /// Multiply many compressed points by one scalar without decompressing
+    /// them first.  Points that fail to decompress give `None`.
+    pub fn mul_batch(bases: &[CompressedRistretto], scalar: &Scalar) -> Vec<Option<CompressedRistretto>> {
+        let mut scaled = vec![CompressedRistretto::identity(); bases.len()];
+        let mut success = vec![0 as ristretto_bool_t; bases.len()];
+
+        unsafe {
+            let _ = ristretto255_direct_scalarmul_fanout(
+                scaled.as_mut_ptr() as *mut u8,
+                success.as_mut_ptr(),
+                bases.as_ptr() as *const u8,
+                &scalar.0,
+                bases.len(),
+                RISTRETTO_TRUE, // Allow identity for testing
+            );
+        }
+
+        scaled
+            .into_iter()
+            .zip(success.into_iter())
+            .map(|(point, ok)| if convert_bool(ok) { Some(point) } else { None })
+            .collect()
+    }
+
+    /// Decompress many points and sum them, using up to `threads` threads.
+    /// Gives `None` if any fails to decompress.
+    pub fn decompress_sum(points: &[CompressedRistretto], threads: u32) -> Option<RistrettoPoint> {
+        let mut sum = uninitialized_point_t();
+        let error = unsafe {
+            ristretto255_point_decode_sum(
+                &mut sum,
+                points.as_ptr() as *const u8,
+                points.len(),
+                RISTRETTO_TRUE, // Allow identity for testing
+                threads,
+            )
+        };
+
+        convert_result(RistrettoPoint(sum), error).ok()
+    }
 }
 
 impl CompressedRistretto {
@@ -93,6 +139,127 @@ impl RistrettoPoint {
         RistrettoPoint(point)
     }
 
+    /// Construct one `RistrettoPoint` from each 64 bytes of data, in one call.
+    pub fn from_uniform_bytes_batch(inputs: &[[u8; 64]]) -> Vec<RistrettoPoint> {
+        let mut points = vec![RistrettoPoint(uninitialized_point_t()); inputs.len()];
+
+        unsafe {
+            ristretto255_point_from_hash_uniform_batch(
+                points.as_mut_ptr() as *mut ristretto255_point_t,
+                inputs.as_ptr() as *const u8,
+                inputs.len(),
+            );
+        }
+
+        points
+    }
+
+    /// The uniform Elligator inverse of this point selected by `which`,
+    /// whose second half is `partial_hash`, if there is one.
+    pub fn to_uniform_bytes(&self, partial_hash: &[u8; 32], which: u32) -> Option<[u8; 64]> {
+        let mut encoding = [0u8; 64];
+        encoding[32..].copy_from_slice(partial_hash);
+
+        let result = unsafe {
+            ristretto255_invert_elligator_uniform(encoding.as_mut_ptr(), &self.0, which)
+        };
+
+        convert_result(encoding, result).ok()
+    }
+
+    /// Every uniform Elligator inverse of this point whose second half is
+    /// `partial_hash`, in one call.  Returns the validity mask, indexed by
+    /// `which`, and the encodings.
+    pub fn to_uniform_bytes_all(&self, partial_hash: &[u8; 32]) -> (u32, Vec<[u8; 64]>) {
+        let mut encodings = vec![[0u8; 64]; 1 << RISTRETTO255_INVERT_ELLIGATOR_WHICH_BITS];
+
+        let mask = unsafe {
+            ristretto255_invert_elligator_uniform_all(
+                encodings.as_mut_ptr() as *mut [u8; 64],
+                &self.0,
+                partial_hash.as_ptr(),
+            )
+        };
+
+        (mask, encodings)
+    }
+
+    /// Uniform Elligator inverses of many points in one call, each with its
+    /// own second half and hint.  Failed points give `None`.
+    pub fn to_uniform_bytes_batch(
+        points: &[RistrettoPoint],
+        partial_hashes: &[[u8; 32]],
+        hints: &[u8],
+    ) -> Vec<Option<[u8; 64]>> {
+        assert_eq!(points.len(), partial_hashes.len());
+        assert_eq!(points.len(), hints.len());
+
+        let mut encodings = vec![[0u8; 64]; points.len()];
+        for (encoding, partial_hash) in encodings.iter_mut().zip(partial_hashes.iter()) {
+            encoding[32..].copy_from_slice(partial_hash);
+        }
+        let mut success = vec![0 as ristretto_bool_t; points.len()];
+
+        unsafe {
+            let _ = ristretto255_invert_elligator_uniform_batch(
+                encodings.as_mut_ptr() as *mut u8,
+                success.as_mut_ptr(),
+                points.as_ptr() as *const ristretto255_point_t,
+                hints.as_ptr(),
+                points.len(),
+            );
+        }
+
+        encodings
+            .into_iter()
+            .zip(success.into_iter())
+            .map(|(encoding, ok)| if convert_bool(ok) { Some(encoding) } else { None })
+            .collect()
+    }
+
+    /// Variable-time scalar multiplication, for public scalars.
+    pub fn mul_non_secret(&self, scalar: &Scalar) -> RistrettoPoint {
+        let mut result = uninitialized_point_t();
+
+        unsafe {
+            ristretto255_point_scalarmul_non_secret(&mut result, &self.0, &scalar.0);
+        }
+
+        RistrettoPoint(result)
+    }
+
+    /// Multiply `self` by each of `scalars`, sharing the doublings.
+    pub fn mul_multiples(&self, scalars: &[Scalar]) -> Vec<RistrettoPoint> {
+        let mut scaled = vec![RistrettoPoint::identity(); scalars.len()];
+
+        unsafe {
+            ristretto255_point_scalarmul_multiples(
+                scaled.as_mut_ptr() as *mut ristretto255_point_t,
+                &self.0,
+                scalars.as_ptr() as *const ristretto255_scalar_t,
+                scalars.len(),
+            );
+        }
+
+        scaled
+    }
+
+    /// As `mul_multiples`, but variable-time in the scalars.
+    pub fn mul_multiples_non_secret(&self, scalars: &[Scalar]) -> Vec<RistrettoPoint> {
+        let mut scaled = vec![RistrettoPoint::identity(); scalars.len()];
+
+        unsafe {
+            ristretto255_point_scalarmul_multiples_non_secret(
+                scaled.as_mut_ptr() as *mut ristretto255_point_t,
+                &self.0,
+                scalars.as_ptr() as *const ristretto255_scalar_t,
+                scalars.len(),
+            );
+        }
+
+        scaled
+    }
+
     /// Return the coset self + E[4], for debugging.
     /// TODO: double check the `EIGHT_TORSION` table is correct
     pub fn coset4(self) -> [Self; 4] {
@@ -113,6 +280,33 @@ impl RistrettoPoint {
     pub fn identity() -> RistrettoPoint {
         RistrettoPoint(unsafe { ristretto255_point_identity })
     }
+
+    /// Variable-time multiple of the basepoint, for public scalars.
+    pub fn basepoint_mul_non_secret(scalar: &Scalar) -> RistrettoPoint {
+        let mut result = uninitialized_point_t();
+
+        unsafe {
+            ristretto255_base_scalarmul_non_secret(&mut result, &scalar.0);
+        }
+
+        RistrettoPoint(result)
+    }
+
+    /// Sum many points, using up to `threads` threads.
+    pub fn sum(points: &[RistrettoPoint], threads: u32) -> RistrettoPoint {
+        let mut result = uninitialized_point_t();
+
+        unsafe {
+            ristretto255_point_sum(
+                &mut result,
+                points.as_ptr() as *const ristretto255_point_t,
+                points.len(),
+                threads,
+            );
+        }
+
+        RistrettoPoint(result)
+    }
 }
 
 impl Default for RistrettoPoint {
@@ -219,6 +413,402 @@ impl From<curve25519_dalek::ristretto::RistrettoPoint> for RistrettoPoint {
     }
 }
 
+// ------------------------------------------------------------------------
+// Key caches, precomputed tables, point blocks and operation counts
+// ------------------------------------------------------------------------
+
+/// Cache of decoded public keys, shareable between threads
+pub struct KeyCache(*mut ristretto255_key_cache_t);
+
+unsafe impl Send for KeyCache {}
+unsafe impl Sync for KeyCache {}
+
+impl KeyCache {
+    /// Create a cache holding about `capacity` keys.
+    pub fn new(capacity: usize) -> KeyCache {
+        let cache = unsafe { ristretto255_key_cache_new(capacity) };
+        assert!(!cache.is_null());
+        KeyCache(cache)
+    }
+
+    /// Decompress `point` through the cache.
+    pub fn decompress(&self, point: &CompressedRistretto) -> Option<RistrettoPoint> {
+        let mut result = uninitialized_point_t();
+        let error = unsafe {
+            ristretto255_key_cache_decode(&mut result, self.0, point.0.as_ptr(), RISTRETTO_FALSE)
+        };
+
+        convert_result(RistrettoPoint(result), error).ok()
+    }
+
+    /// Compute `a*B + b*A` for the basepoint `B` and the key `A`, as in
+    /// signature verification.
+    pub fn basepoint_double_mul_non_secret(
+        &self,
+        a: &Scalar,
+        A: &CompressedRistretto,
+        b: &Scalar,
+    ) -> Option<RistrettoPoint> {
+        let mut result = uninitialized_point_t();
+        let error = unsafe {
+            ristretto255_key_cache_base_double_scalarmul_non_secret(
+                &mut result,
+                self.0,
+                &a.0,
+                A.0.as_ptr(),
+                &b.0,
+                RISTRETTO_FALSE,
+            )
+        };
+
+        convert_result(RistrettoPoint(result), error).ok()
+    }
+
+    /// Lookups answered from the cache, and lookups that missed.
+    pub fn stats(&self) -> (u64, u64) {
+        let (mut hits, mut misses) = (0, 0);
+        unsafe { ristretto255_key_cache_stats(self.0, &mut hits, &mut misses) }
+        (hits, misses)
+    }
+}
+
+impl Drop for KeyCache {
+    fn drop(&mut self) {
+        unsafe { ristretto255_key_cache_free(self.0) }
+    }
+}
+
+/// Points held four to a block, limb by limb
+pub struct PointBlocks {
+    blocks: Vec<ristretto255_point_block_t>,
+    count: usize,
+}
+
+impl PointBlocks {
+    fn with_len(count: usize) -> PointBlocks {
+        let nblocks = (count + RISTRETTO255_POINT_BLOCK_LANES - 1) / RISTRETTO255_POINT_BLOCK_LANES;
+        PointBlocks { blocks: vec![unsafe { mem::zeroed() }; nblocks], count }
+    }
+
+    /// Pack `points` into blocks.
+    pub fn new(points: &[RistrettoPoint]) -> PointBlocks {
+        let mut result = PointBlocks::with_len(points.len());
+        unsafe {
+            ristretto255_point_block_load(
+                result.blocks.as_mut_ptr(),
+                points.as_ptr() as *const ristretto255_point_t,
+                points.len(),
+            );
+        }
+        result
+    }
+
+    /// Unpack the points.
+    pub fn to_points(&self) -> Vec<RistrettoPoint> {
+        let mut points = vec![RistrettoPoint(uninitialized_point_t()); self.count];
+        unsafe {
+            ristretto255_point_block_store(
+                points.as_mut_ptr() as *mut ristretto255_point_t,
+                self.blocks.as_ptr(),
+                self.count,
+            );
+        }
+        points
+    }
+
+    /// Add the points of `other` to these, pointwise.
+    pub fn add(&self, other: &PointBlocks) -> PointBlocks {
+        assert_eq!(self.count, other.count);
+        let mut result = PointBlocks::with_len(self.count);
+        unsafe {
+            ristretto255_point_block_add(
+                result.blocks.as_mut_ptr(),
+                self.blocks.as_ptr(),
+                other.blocks.as_ptr(),
+                self.count,
+            );
+        }
+        result
+    }
+
+    /// Double every point, in place.
+    pub fn double(&mut self) {
+        let blocks = self.blocks.as_mut_ptr();
+        unsafe { ristretto255_point_block_double(blocks, blocks, self.count) }
+    }
+
+    /// Compress every point.
+    pub fn compress(&self) -> Vec<CompressedRistretto> {
+        let mut compressed = vec![CompressedRistretto::identity(); self.count];
+        unsafe {
+            ristretto255_point_block_encode(
+                compressed.as_mut_ptr() as *mut u8,
+                self.blocks.as_ptr(),
+                self.count,
+            );
+        }
+        compressed
+    }
+
+    /// Decompress `points` into blocks.  Points that fail to decompress
+    /// are replaced by the identity and flagged `false`.
+    pub fn decompress(points: &[CompressedRistretto]) -> (PointBlocks, Vec<bool>) {
+        let mut result = PointBlocks::with_len(points.len());
+        let mut success = vec![0 as ristretto_bool_t; points.len()];
+        unsafe {
+            let _ = ristretto255_point_block_decode(
+                result.blocks.as_mut_ptr(),
+                success.as_mut_ptr(),
+                points.as_ptr() as *const u8,
+                points.len(),
+                RISTRETTO_TRUE, // Allow identity for testing
+            );
+        }
+        (result, success.into_iter().map(convert_bool).collect())
+    }
+}
+
+/// A point prepared for repeated addition
+#[derive(Copy, Clone)]
+pub struct CachedPoint(pub ristretto255_point_cached_t);
+
+impl CachedPoint {
+    /// Prepare `point` for repeated addition.
+    pub fn new(point: &RistrettoPoint) -> CachedPoint {
+        unsafe {
+            let mut cached = mem::zeroed();
+            ristretto255_point_to_cached(&mut cached, &point.0);
+            CachedPoint(cached)
+        }
+    }
+
+    /// Add this point to `point`.
+    pub fn add_to(&self, point: &RistrettoPoint) -> RistrettoPoint {
+        let mut result = uninitialized_point_t();
+        unsafe { ristretto255_point_add_cached(&mut result, &point.0, &self.0) }
+        RistrettoPoint(result)
+    }
+
+    /// Subtract this point from `point`.
+    pub fn sub_from(&self, point: &RistrettoPoint) -> RistrettoPoint {
+        let mut result = uninitialized_point_t();
+        unsafe { ristretto255_point_sub_cached(&mut result, &point.0, &self.0) }
+        RistrettoPoint(result)
+    }
+
+    /// Normalize `points` to z=1.
+    pub fn normalize(points: &[CachedPoint]) -> Vec<AffineCachedPoint> {
+        let mut result = vec![AffineCachedPoint(unsafe { mem::zeroed() }); points.len()];
+        unsafe {
+            ristretto255_point_cached_normalize(
+                result.as_mut_ptr() as *mut ristretto255_point_affine_cached_t,
+                points.as_ptr() as *const ristretto255_point_cached_t,
+                points.len(),
+            );
+        }
+        result
+    }
+}
+
+/// A cached point normalized to z=1
+#[derive(Copy, Clone)]
+pub struct AffineCachedPoint(pub ristretto255_point_affine_cached_t);
+
+impl AffineCachedPoint {
+    /// Add this point to `point`.
+    pub fn add_to(&self, point: &RistrettoPoint) -> RistrettoPoint {
+        let mut result = uninitialized_point_t();
+        unsafe { ristretto255_point_add_affine_cached(&mut result, &point.0, &self.0) }
+        RistrettoPoint(result)
+    }
+
+    /// Subtract this point from `point`.
+    pub fn sub_from(&self, point: &RistrettoPoint) -> RistrettoPoint {
+        let mut result = uninitialized_point_t();
+        unsafe { ristretto255_point_sub_affine_cached(&mut result, &point.0, &self.0) }
+        RistrettoPoint(result)
+    }
+}
+
+/// Comb tables for many points, built together
+pub struct PrecomputedTables {
+    tables: *mut u8,
+    layout: Layout,
+    count: usize,
+}
+
+impl PrecomputedTables {
+    /// Build a table for each of `points`, using up to `threads` threads.
+    pub fn new(points: &[RistrettoPoint], threads: u32) -> PrecomputedTables {
+        let layout = unsafe {
+            Layout::from_size_align(
+                ristretto255_sizeof_precomputed_s * points.len().max(1),
+                ristretto255_alignof_precomputed_s,
+            ).unwrap()
+        };
+
+        unsafe {
+            let tables = alloc::alloc(layout);
+            ristretto255_precompute_batch(
+                tables as *mut ristretto255_precomputed_s,
+                points.as_ptr() as *const ristretto255_point_t,
+                points.len(),
+                threads,
+            );
+            PrecomputedTables { tables, layout, count: points.len() }
+        }
+    }
+
+    /// As `new`, on one thread, normalizing every table with a single
+    /// inversion in a separately allocated workspace.
+    pub fn new_single_inversion(points: &[RistrettoPoint]) -> PrecomputedTables {
+        let layout = unsafe {
+            Layout::from_size_align(
+                ristretto255_sizeof_precomputed_s * points.len().max(1),
+                ristretto255_alignof_precomputed_s,
+            ).unwrap()
+        };
+        let ws_layout = unsafe {
+            Layout::from_size_align(
+                ristretto255_workspace_size(RISTRETTO255_WS_PRECOMPUTE_BATCH, points.len()).max(1),
+                ristretto255_alignof_precomputed_s,
+            ).unwrap()
+        };
+
+        unsafe {
+            let (table_mem, workspace) = (alloc::alloc(layout), alloc::alloc(ws_layout));
+            ristretto255_precompute_batch_ws(
+                table_mem as *mut ristretto255_precomputed_s,
+                points.as_ptr() as *const ristretto255_point_t,
+                points.len(),
+                workspace as *mut _,
+            );
+            alloc::dealloc(workspace, ws_layout);
+            PrecomputedTables { tables: table_mem, layout, count: points.len() }
+        }
+    }
+
+    /// Multiply the `i`th point by `scalar`.
+    pub fn mul(&self, i: usize, scalar: &Scalar) -> RistrettoPoint {
+        assert!(i < self.count);
+        let mut result = uninitialized_point_t();
+
+        unsafe {
+            let table = self.tables.add(i * ristretto255_sizeof_precomputed_s);
+            ristretto255_precomputed_scalarmul(
+                &mut result,
+                table as *const ristretto255_precomputed_s,
+                &scalar.0,
+            );
+        }
+
+        RistrettoPoint(result)
+    }
+}
+
+impl Drop for PrecomputedTables {
+    fn drop(&mut self) {
+        unsafe { alloc::dealloc(self.tables, self.layout) }
+    }
+}
+
+/// A file of wNAF tables, one per point, mapped and used in place
+pub struct WnafTableFile(ristretto255_table_file_t);
+
+impl WnafTableFile {
+    /// Precompute a table for each of `points` and write them to `path`.
+    pub fn write(path: &Path, points: &[RistrettoPoint]) -> io::Result<()> {
+        let (table_size, layout) = unsafe {
+            (
+                ristretto255_sizeof_precomputed_wnaf_s,
+                Layout::from_size_align(
+                    ristretto255_sizeof_precomputed_wnaf_s * points.len().max(1),
+                    ristretto255_alignof_precomputed_s,
+                ).unwrap(),
+            )
+        };
+        let mut file = vec![0u8; unsafe {
+            ristretto255_table_file_bytes(RISTRETTO255_TABLE_WNAF, points.len())
+        }];
+
+        unsafe {
+            let tables = alloc::alloc(layout);
+            for (i, point) in points.iter().enumerate() {
+                ristretto255_precompute_wnaf(
+                    tables.add(i * table_size) as *mut ristretto255_precomputed_wnaf_s,
+                    &point.0,
+                );
+            }
+            ristretto255_table_file_encode_wnaf(
+                file.as_mut_ptr(),
+                tables as *const ristretto255_precomputed_wnaf_s,
+                points.len(),
+            );
+            alloc::dealloc(tables, layout);
+        }
+
+        fs::write(path, &file)
+    }
+
+    /// Map the tables in `path`, checking the digest if `verify`.
+    pub fn map(path: &Path, verify: bool) -> Option<WnafTableFile> {
+        let path = CString::new(path.as_os_str().as_bytes()).ok()?;
+        let mut map: ristretto255_table_file_t = unsafe { mem::zeroed() };
+
+        let result = unsafe {
+            ristretto255_table_file_map(
+                &mut map,
+                path.as_ptr(),
+                RISTRETTO255_TABLE_WNAF,
+                if verify { RISTRETTO_TRUE } else { RISTRETTO_FALSE },
+            )
+        };
+
+        convert_result(WnafTableFile(map), result).ok()
+    }
+
+    /// Number of tables in the file.
+    pub fn len(&self) -> usize {
+        self.0.count
+    }
+
+    /// Multiply the `i`th point by a public scalar.
+    pub fn mul_non_secret(&self, i: usize, scalar: &Scalar) -> Option<RistrettoPoint> {
+        let mut result = uninitialized_point_t();
+
+        unsafe {
+            let table = ristretto255_table_file_wnaf(&self.0, i);
+            if table.is_null() {
+                return None;
+            }
+            ristretto255_precomputed_wnaf_scalarmul_non_secret(&mut result, table, &scalar.0);
+        }
+
+        Some(RistrettoPoint(result))
+    }
+}
+
+impl Drop for WnafTableFile {
+    fn drop(&mut self) {
+        unsafe { ristretto255_table_file_unmap(&mut self.0) }
+    }
+}
+
+/// The calling thread's operation counts since the last reset, if the
+/// library was built with `make STATS=1`.
+pub fn op_stats(reset: bool) -> Option<ristretto255_stats_t> {
+    let mut stats = ristretto255_stats_t::default();
+    let enabled = unsafe { ristretto255_stats_snapshot(&mut stats) };
+    if reset {
+        unsafe { ristretto255_stats_reset() }
+    }
+    if convert_bool(enabled) {
+        Some(stats)
+    } else {
+        None
+    }
+}
+
 // ------------------------------------------------------------------------
 // Debug traits
 // ------------------------------------------------------------------------
@@ -10,6 +10,7 @@ use util::convert_bool;
 
 /// Scalars (i.e. wrapper around `ristretto255_scalar_t`)
 #[derive(Copy, Clone)]
+#[repr(C)]
 pub struct Scalar(pub(crate) ristretto255_scalar_t);
 
 impl Scalar {
@@ -82,6 +83,63 @@ impl Mul<Scalar> for Scalar {
     }
 }
 
+// ------------------------------------------------------------------------
+// Batched arithmetic
+// ------------------------------------------------------------------------
+
+impl Scalar {
+    /// Elementwise product of two equal-length slices
+    pub fn mul_batch(a: &[Scalar], b: &[Scalar]) -> Vec<Scalar> {
+        assert_eq!(a.len(), b.len());
+        let mut result = vec![Scalar(uninitialized_scalar_t()); a.len()];
+
+        unsafe {
+            ristretto255_scalar_mul_batch(
+                result.as_mut_ptr() as *mut ristretto255_scalar_t,
+                a.as_ptr() as *const ristretto255_scalar_t,
+                b.as_ptr() as *const ristretto255_scalar_t,
+                a.len(),
+            );
+        }
+
+        result
+    }
+
+    /// Elementwise sum of two equal-length slices
+    pub fn add_batch(a: &[Scalar], b: &[Scalar]) -> Vec<Scalar> {
+        assert_eq!(a.len(), b.len());
+        let mut result = vec![Scalar(uninitialized_scalar_t()); a.len()];
+
+        unsafe {
+            ristretto255_scalar_add_batch(
+                result.as_mut_ptr() as *mut ristretto255_scalar_t,
+                a.as_ptr() as *const ristretto255_scalar_t,
+                b.as_ptr() as *const ristretto255_scalar_t,
+                a.len(),
+            );
+        }
+
+        result
+    }
+
+    /// Elementwise difference of two equal-length slices
+    pub fn sub_batch(a: &[Scalar], b: &[Scalar]) -> Vec<Scalar> {
+        assert_eq!(a.len(), b.len());
+        let mut result = vec![Scalar(uninitialized_scalar_t()); a.len()];
+
+        unsafe {
+            ristretto255_scalar_sub_batch(
+                result.as_mut_ptr() as *mut ristretto255_scalar_t,
+                a.as_ptr() as *const ristretto255_scalar_t,
+                b.as_ptr() as *const ristretto255_scalar_t,
+                a.len(),
+            );
+        }
+
+        result
+    }
+}
+
 // ------------------------------------------------------------------------
 // Type conversions
 // ------------------------------------------------------------------------
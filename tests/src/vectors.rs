@@ -6,6 +6,8 @@
 
 use ristretto::{CompressedRistretto, RistrettoPoint};
 use hex;
+use libristretto255_sys::*;
+use std::mem;
 //use sha2::{Digest, Sha512};
 
 /// Test the byte encodings of small multiples
@@ -130,3 +132,73 @@ pub fn bad_encodings() {
 //        );
 //    }
 //}
+
+/// expand_message_xmd with SHA-512, from RFC 9380 appendix K.3
+#[test]
+fn expand_message_xmd_sha512() {
+    let tag = b"QUUX-V01-CS02-with-expander-SHA512-256";
+    let vectors: [(&[u8], &str); 3] = [
+        (b"", "6b9a7312411d92f921c6f68ca0b6380730a1a4d982c507211a90964c394179ba"),
+        (b"abc", "0da749f12fbe5483eb066a5f595055679b976e93abe9be6f0f6318bce7aca8dc"),
+        (b"abcdef0123456789", "087e45a86e2939ee8b91100af1583c4938e0f5fc6c9db4b107b83346bc967f58"),
+    ];
+
+    let mut dst: ristretto255_hash_dst_t = unsafe { mem::zeroed() };
+    unsafe { ristretto255_hash_dst_init(&mut dst, tag.as_ptr(), tag.len()) };
+
+    for &(msg, expected) in vectors.iter() {
+        let mut out = [0u8; 32];
+        let mut ctx: ristretto255_hash_t = unsafe { mem::zeroed() };
+
+        // Stream the message a byte at a time
+        let error = unsafe {
+            ristretto255_hash_init(&mut ctx, &dst);
+            for byte in msg.iter() {
+                ristretto255_hash_update(&mut ctx, byte, 1);
+            }
+            ristretto255_hash_final(&mut ctx, out.as_mut_ptr(), out.len())
+        };
+        assert_eq!(error, RISTRETTO_SUCCESS);
+        assert_eq!(hex::encode(&out), expected);
+
+        // hash_to_group is from_hash_uniform of 64 bytes of the same
+        let mut uniform = [0u8; 64];
+        let mut point: ristretto255_point_t = unsafe { mem::zeroed() };
+        unsafe {
+            ristretto255_hash_init(&mut ctx, &dst);
+            ristretto255_hash_update(&mut ctx, msg.as_ptr(), msg.len());
+            assert_eq!(ristretto255_hash_final(&mut ctx, uniform.as_mut_ptr(), 64), RISTRETTO_SUCCESS);
+            ristretto255_hash_to_group(&mut point, msg.as_ptr(), msg.len(), &dst);
+        }
+        assert_eq!(RistrettoPoint::from(point), RistrettoPoint::from_uniform_bytes(&uniform));
+    }
+}
+
+#[test]
+fn hash_batch_matches_single() {
+    let mut dst: ristretto255_hash_dst_t = unsafe { mem::zeroed() };
+    unsafe { ristretto255_hash_dst_init(&mut dst, b"batch-test".as_ptr(), 10) };
+
+    // Ragged lengths, crossing block boundaries, and a count that leaves a tail
+    let messages: Vec<Vec<u8>> = (0..37).map(|i| vec![i as u8; (i * 29) % 300]).collect();
+    let ptrs: Vec<*const u8> = messages.iter().map(|m| m.as_ptr()).collect();
+    let lens: Vec<usize> = messages.iter().map(|m| m.len()).collect();
+
+    let mut points: Vec<ristretto255_point_t> = vec![unsafe { mem::zeroed() }; messages.len()];
+    let mut scalars: Vec<ristretto255_scalar_t> = vec![unsafe { mem::zeroed() }; messages.len()];
+    unsafe {
+        ristretto255_hash_to_group_batch(points.as_mut_ptr(), ptrs.as_ptr(), lens.as_ptr(), messages.len(), &dst);
+        ristretto255_hash_to_scalar_batch(scalars.as_mut_ptr(), ptrs.as_ptr(), lens.as_ptr(), messages.len(), &dst);
+    }
+
+    for (i, msg) in messages.iter().enumerate() {
+        let mut point: ristretto255_point_t = unsafe { mem::zeroed() };
+        let mut scalar: ristretto255_scalar_t = unsafe { mem::zeroed() };
+        unsafe {
+            ristretto255_hash_to_group(&mut point, msg.as_ptr(), msg.len(), &dst);
+            ristretto255_hash_to_scalar(&mut scalar, msg.as_ptr(), msg.len(), &dst);
+            assert_eq!(ristretto255_point_eq(&point, &points[i]), RISTRETTO_TRUE);
+            assert_eq!(ristretto255_scalar_eq(&scalar, &scalars[i]), RISTRETTO_TRUE);
+        }
+    }
+}